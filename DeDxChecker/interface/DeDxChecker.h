@@ -41,7 +41,6 @@ class DeDxChecker: public edm::EDAnalyzer{
 
     virtual void beginJob();
     virtual void endJob();
-    void Init(const edm::EventSetup&) ;
     virtual void analyze(const edm::Event&, const edm::EventSetup&);
   private:
     void GetDeDxStrips(const reco::Track &Track);
@@ -13,11 +13,6 @@
 #include "DataFormats/TrackReco/interface/TrackFwd.h"
 #include "DataFormats/Common/interface/Handle.h"
 
-#include "DataFormats/TrackerRecHit2D/interface/SiStripRecHit2D.h"
-#include "DataFormats/TrackerRecHit2D/interface/SiStripMatchedRecHit2D.h"
-#include "DataFormats/TrackerRecHit2D/interface/SiPixelRecHit.h"
-#include "DataFormats/TrackerRecHit2D/interface/ProjectedSiStripRecHit2D.h"
-#include "DataFormats/TrackerRecHit2D/interface/SiStripRecHit1D.h"
 #include "DataFormats/TrackReco/interface/DeDxData.h"
 
 //#include "Geometry/TrackerGeometryBuilder/interface/TrackerGeometry.h"
@@ -26,7 +21,7 @@
 //#include "Geometry/TrackerGeometryBuilder/interface/PixelGeomDetUnit.h"
 //#include "Geometry/Records/interface/GlobalTrackingGeometryRecord.h"
 
-#include "RecoTracker/DeDx/interface/DeDxTools.h"
+#include "Monopoles/MonoAlgorithms/interface/MonoStripAmplitudes.h"
 
 //#include "DataFormats/GeometryCommonDetAlgo/interface/ErrorFrameTransformer.h"
 
@@ -71,32 +66,7 @@ void DeDxChecker::endJob(){
   _OutputFile->Close();
 }
 
-/*
-void DeDxChecker::Init(const edm::EventSetup& iSetup) {
-  iSetup.get<GlobalTrackingGeometryRecord>().get(_TrackingGeom);
-
-  // Fill Normalization map
-  edm::ESHandle<TrackerGeometry> tkGeom;
-  iSetup.get<TrackerDigiGeometryRecord>().get( tkGeom );
-
-  vector<GeomDet*> Det = tkGeom->dets();
-  for(uint i=0; i<Det.size(); i++){
-    DetId Detid = Det[i]->geographicalId();
-
-    StripGeomDetUnit* StripDetUnit = dynamic_cast<StripGeomDetUnit*> (Det[i]);
-    PixelGeomDetUnit* PixelDetUnit = dynamic_cast<PixelGeomDetUnit*> (Det[i]);
-
-    if(StripDetUnit){
-      _NormMap[Detid.rawId()] = _MeVperADCStrip / StripDetUnit->surface().bounds().thickness();
-    }else if(PixelDetUnit){
-      _NormMap[Detid.rawId()] = _MeVperADCPixel / PixelDetUnit->surface().bounds().thickness();
-    }
-  }
-}*/
-
 void DeDxChecker::analyze(const Event& event, const EventSetup& setup){
-  //if(_NormMap.size() == 0) Init(setup);
-
   event.getByLabel("generalTracks", _hTracks);
   //event.getByLabel(_Source, _hTrajectories);
   //event.getByLabel(_Source, _hTrajTrackAssociations);
@@ -138,58 +108,15 @@ void DeDxChecker::GetDeDxStrips(const reco::Track &Track){
 
     if(!Hit->isValid()) continue;
 
-    // add the dedx information: different accessor for every type of hit
-
-    if(const SiStripMatchedRecHit2D* matchedHit=dynamic_cast<const SiStripMatchedRecHit2D*>(Hit)){
-      const vector<uint8_t>& Ampls = DeDxTools::GetCluster(matchedHit->stereoHit())->amplitudes();
-      _TotStrips += Ampls.size();
-      _HitTotStrips.push_back(Ampls.size());
-
-      int Saturated=0;
-      for(uint i=0; i<Ampls.size(); i++){
-	if(Ampls[i] >= 254) Saturated++;
-      }
-      _SatStrips += Saturated;
-      _HitSatStrips.push_back(Saturated);
-    }else if(const ProjectedSiStripRecHit2D* projectedHit=dynamic_cast<const ProjectedSiStripRecHit2D*>(Hit)) {
-      const vector<uint8_t>& Ampls = DeDxTools::GetCluster(&(projectedHit->originalHit()))->amplitudes();
-      _TotStrips += Ampls.size();
-      _HitTotStrips.push_back(Ampls.size());
-
-      int Saturated=0;
-      for(uint i=0; i<Ampls.size(); i++){
-	if(Ampls[i] >= 254) Saturated++;
-      }
-      _SatStrips += Saturated;
-      _HitSatStrips.push_back(Saturated);
-    }else if(const SiStripRecHit2D* singleHit=dynamic_cast<const SiStripRecHit2D*>(Hit)){
-      const vector<uint8_t>& Ampls = DeDxTools::GetCluster(singleHit)->amplitudes();
-      _TotStrips += Ampls.size();
-      _HitTotStrips.push_back(Ampls.size());
-
-      int Saturated=0;
-      for(uint i=0; i<Ampls.size(); i++){
-	if(Ampls[i] >= 254) Saturated++;
-      }
-      _SatStrips += Saturated;
-      _HitSatStrips.push_back(Saturated);
-    }else if(const SiStripRecHit1D* single1DHit=dynamic_cast<const SiStripRecHit1D*>(Hit)){
-      const vector<uint8_t>& Ampls = DeDxTools::GetCluster(single1DHit)->amplitudes();
-      _TotStrips += Ampls.size();
-      _HitTotStrips.push_back(Ampls.size());
-
-      int Saturated=0;
-      for(uint i=0; i<Ampls.size(); i++){
-	if(Ampls[i] >= 254) Saturated++;
-      }
-      _SatStrips += Saturated;
-      _HitSatStrips.push_back(Saturated);
-// don't use pixels for now (since the standard algorithms don't use them)
-    }else if(const SiPixelRecHit* pixelHit=dynamic_cast<const SiPixelRecHit*>(Hit)){ 
-//      Charge = pixelHit->cluster()->charge();
-    }
-
-    //cout << "Adding Charge: " << Charge << " * " << abs(cosine) << " * " << _NormMap[Hit->geographicalId().rawId()] << endl;
+    // add the dedx information, strips only
+    Mono::StripAmplitudes Ampls;
+    Mono::getStripAmplitudes(Hit, Ampls);
+    if(Ampls.type != Mono::StripAmplitudes::kStrip) continue;
+
+    _TotStrips += Ampls.strips;
+    _HitTotStrips.push_back(Ampls.strips);
+    _SatStrips += Ampls.saturated;
+    _HitSatStrips.push_back(Ampls.saturated);
   }
 }
 
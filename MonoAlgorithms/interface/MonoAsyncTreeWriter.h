@@ -0,0 +1,139 @@
+#ifndef Monopoles_MonoAlgorithms_MonoAsyncTreeWriter_h
+#define Monopoles_MonoAlgorithms_MonoAsyncTreeWriter_h
+
+////////////////////////////////////
+// Fills a TTree on a writer thread,
+// so basket compression and output
+// overlap with the next events.  The
+// branches keep pointing at the
+// analyzer's members on the event
+// side: fill() copies them into one
+// of depth slots and queues it, the
+// writer swaps the slot into its own
+// copies, which the branches are
+// rebound to, and fills the tree in
+// queue order.  fill() only waits when
+// all slots are queued (the stall).
+// Depth 0 fills on the calling thread,
+// the default of the dumper; a writer
+// thread sets up ROOT's thread locks
+// (TThread::Initialize) first.
+//
+// Leaf-list branches with one leaf and
+// vectors of basic types and strings
+// are bound by start(); other branch
+// types need a bind<T>(name) first.
+// Nothing else may write to the file
+// of the tree between start and stop.
+////////////////////////////////////
+
+#include "TTree.h"
+#include "TBranch.h"
+#include "TBranchElement.h"
+#include "TStopwatch.h"
+
+#include "tbb/concurrent_queue.h"
+#include "tbb/tbb_thread.h"
+
+#include <vector>
+#include <deque>
+#include <string>
+#include <map>
+
+namespace Mono {
+
+class MonoAsyncTreeWriter {
+
+public:
+
+  explicit MonoAsyncTreeWriter(unsigned depth);
+
+  virtual ~MonoAsyncTreeWriter();
+
+  // a branch of type T (the member's type) that start() cannot bind itself
+  template <class T> void bind(const std::string &branch) { m_bound[branch] = new Column<T>(m_depth); }
+
+  // take over filling tree, whose branches are all made
+  void start(TTree *tree);
+
+  // queue the current values of the branches as the next entry
+  void fill();
+
+  // write the queued entries and stop the writer thread
+  void stop();
+
+  inline unsigned depth() const { return m_depth; }
+  inline unsigned long long entries() const { return m_entries; }
+
+  // time fill() waited for a free slot, and time the writer spent filling
+  inline double stallTime() const { return m_stallWatch.RealTime(); }
+  inline double writeTime() const { return m_writeWatch.RealTime(); }
+
+private:
+
+  MonoAsyncTreeWriter(const MonoAsyncTreeWriter &);
+  MonoAsyncTreeWriter & operator=(const MonoAsyncTreeWriter &);
+
+  // the values of one branch: the analyzer's member, depth slots,
+  // and the writer's copy the branch reads from after start()
+  struct ColumnBase {
+    virtual ~ColumnBase() { }
+    virtual void attach(TTree *tree, TBranch *branch) = 0;
+    virtual void detach() = 0;
+    virtual void save(unsigned slot) = 0;
+    virtual void load(unsigned slot) = 0;
+  };
+
+  template <class T> struct Column : public ColumnBase {
+    explicit Column(unsigned depth) : tree(0), element(false), source(0), sourcePtr(0), outPtr(&out), slots(depth) { }
+
+    // by name through the tree: SetBranchAddress also moves the
+    // sub-branches of a split object, TBranchElement::SetObject does not
+    void attach(TTree *t, TBranch *b) {
+      tree = t;
+      name = b->GetName();
+      element = dynamic_cast<TBranchElement*>(b) != 0;
+      source = (T*)(element ? ((TBranchElement*)b)->GetObject() : b->GetAddress());
+      out = *source;
+      if ( element ) tree->SetBranchAddress(name.c_str(),&outPtr);
+      else tree->SetBranchAddress(name.c_str(),&out);
+    }
+    void detach() {
+      sourcePtr = source;
+      if ( element ) tree->SetBranchAddress(name.c_str(),&sourcePtr);
+      else tree->SetBranchAddress(name.c_str(),source);
+    }
+    void save(unsigned slot) { slots[slot] = *source; }
+    void load(unsigned slot) { std::swap(out,slots[slot]); }
+
+    TTree *tree;
+    std::string name;
+    bool element;
+    T *source, *sourcePtr;
+    T *outPtr;
+    std::deque<T> slots;  // not a vector, which would pack bools
+    T out;
+  };
+
+  static ColumnBase * column(TBranch *branch, unsigned depth);
+
+  void run();
+  struct Runner;
+
+  unsigned m_depth;
+  TTree *m_tree;
+  tbb::tbb_thread *m_thread;
+
+  std::map<std::string,ColumnBase *> m_bound;
+  std::vector<ColumnBase *> m_columns;
+
+  // slot indices; -1 on m_full stops the writer
+  tbb::concurrent_bounded_queue<int> m_free, m_full;
+
+  unsigned long long m_entries;
+  TStopwatch m_stallWatch, m_writeWatch;
+};
+
+}
+
+#endif
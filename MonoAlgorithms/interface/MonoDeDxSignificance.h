@@ -0,0 +1,55 @@
+#ifndef Monopoles_MonoAlgorithms_MonoDeDxSignificance_h
+#define Monopoles_MonoAlgorithms_MonoDeDxSignificance_h
+
+////////////////////////////////////
+// dE/dx significance of a track,
+// sqrt(-ln P) with P the chance of
+// at least satSubHits saturated
+// strips out of subHits when each
+// saturates with probability prob,
+// as TMath::BinomialI.  Tabulated up
+// to maxHits subhits by summing the
+// binomial tail in log space (one
+// minus the head where P is near 1),
+// so it stays finite where BinomialI
+// underflows; longer tracks sum
+// their own tail, the incomplete
+// beta I_prob(k, n-k+1), the same way.
+////////////////////////////////////
+
+#include <vector>
+
+namespace Mono {
+
+class MonoDeDxSignificance {
+
+public:
+
+  explicit MonoDeDxSignificance(double prob=0.07, unsigned maxHits=1024);
+
+  inline virtual ~MonoDeDxSignificance() { }
+
+  // rebuild the table
+  void setup(double prob, unsigned maxHits);
+
+  // significance of satSubHits saturated of subHits strips
+  double operator()(int subHits, int satSubHits) const;
+
+  // ln P(X >= k) of a binomial X of n trials with probability prob
+  static double logTail(double prob, int n, int k);
+
+  inline double probability() const { return m_prob; }
+  inline unsigned maxHits() const { return m_maxHits; }
+
+private:
+
+  double m_prob;
+  unsigned m_maxHits;
+
+  // row n of n+1 entries k = 0..n at n(n+1)/2
+  std::vector<float> m_table;
+};
+
+}
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef Monopoles_MonoAlgorithms_MonoEcalGeomTable_h
+#define Monopoles_MonoAlgorithms_MonoEcalGeomTable_h
+
+////////////////////////////////////
+// Crystal positions of the Ecal
+// barrel and endcap as flat eta, phi,
+// x, y, z arrays indexed by the
+// DetId hashedIndex().  Rebuilt when
+// the calo geometry IOV changes; one
+// table is shared by all the modules
+// of the job through shared().
+////////////////////////////////////
+
+#include "DataFormats/EcalDetId/interface/EBDetId.h"
+#include "DataFormats/EcalDetId/interface/EEDetId.h"
+
+#include <vector>
+
+namespace edm {
+class EventSetup;
+}
+
+namespace Mono {
+
+class MonoEcalGeomTable {
+
+public:
+
+  enum Part { kEB=0, kEE, kNParts };
+
+  // positions of one part, each hashedIndex() long
+  struct Cells {
+    std::vector<float> eta, phi;
+    std::vector<float> x, y, z;
+  };
+
+  MonoEcalGeomTable();
+
+  inline virtual ~MonoEcalGeomTable() { }
+
+  // the table of the job, brought up to date with es
+  static const MonoEcalGeomTable & shared(const edm::EventSetup &es);
+
+  // rebuild if the calo geometry changed, returns true if it did
+  bool update(const edm::EventSetup &es);
+
+  inline const Cells & cells(Part part) const { return m_cells[part]; }
+  inline const Cells & eb() const { return m_cells[kEB]; }
+  inline const Cells & ee() const { return m_cells[kEE]; }
+
+  // position of a crystal
+  inline float eta(const EBDetId &id) const { return m_cells[kEB].eta[id.hashedIndex()]; }
+  inline float phi(const EBDetId &id) const { return m_cells[kEB].phi[id.hashedIndex()]; }
+  inline float eta(const EEDetId &id) const { return m_cells[kEE].eta[id.hashedIndex()]; }
+  inline float phi(const EEDetId &id) const { return m_cells[kEE].phi[id.hashedIndex()]; }
+
+private:
+
+  void fill(const edm::EventSetup &es);
+
+  unsigned long long m_cacheId;
+
+  Cells m_cells[kNParts];
+};
+
+}
+
+#endif
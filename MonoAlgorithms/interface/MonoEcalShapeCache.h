@@ -0,0 +1,86 @@
+#ifndef Monopoles_MonoAlgorithms_MonoEcalShapeCache_h
+#define Monopoles_MonoAlgorithms_MonoEcalShapeCache_h
+
+////////////////////////////////////
+// e5x5, e5x1, e1x5, eMax and e2x5
+// left/right of basic clusters, as
+// EcalClusterTools computes them, from
+// one 5x5 window per seed crystal.
+// The RecHit energies of an event are
+// spread into dense EB/EE arrays by
+// hashedIndex(); the crystals and
+// energies of the window around a seed
+// are navigated and looked up once per
+// event, however many collections
+// have a cluster on that seed.  The
+// cluster fractions weight the window
+// per cluster, so clusters sharing a
+// seed but not all their crystals get
+// their own EcalClusterTools values.
+////////////////////////////////////
+
+#include "DataFormats/EcalRecHit/interface/EcalRecHitCollections.h"
+#include "DataFormats/EgammaReco/interface/BasicCluster.h"
+
+#include <vector>
+#include <map>
+
+class CaloTopology;
+
+namespace Mono {
+
+class MonoEcalShapeCache {
+
+public:
+
+  struct Shape {
+    float e55, e51, e15, eMax;
+    float e25Right, e25Left;
+  };
+
+  // disabled: every shape straight from EcalClusterTools, for comparison
+  explicit MonoEcalShapeCache(bool enable=true);
+
+  inline virtual ~MonoEcalShapeCache() { }
+
+  // forget the previous event and spread the RecHits of this one
+  void newEvent(const EcalRecHitCollection *ebHits, const EcalRecHitCollection *eeHits
+    ,const CaloTopology *topology);
+
+  // the e2x5 only if sides, EcalClusterTools does not give them for free
+  Shape shape(const reco::BasicCluster &cluster, bool sides=false);
+
+private:
+
+  enum Part { kEB=0, kEE, kNParts };
+
+  // cell (i,j) of the window is at (i+2)*5+j+2, i and j the
+  // CaloNavigator offsets; -1 where navigation left the part
+  struct Window {
+    unsigned part;
+    int idx[25];
+    float energy[25];
+  };
+
+  static bool index(const DetId &id, unsigned &part, int &idx);
+
+  void fill(unsigned part, const EcalRecHitCollection *hits);
+  const Window & window(const DetId &seed);
+
+  bool m_enable;
+
+  const EcalRecHitCollection *m_hits[kNParts];
+  const CaloTopology *m_topology;
+
+  // dense by hashedIndex(), zero where there is no RecHit
+  // (fraction: no crystal of the current cluster)
+  std::vector<float> m_energy[kNParts];
+  std::vector<float> m_fraction[kNParts];
+  std::vector<int> m_filled[kNParts];
+
+  std::map<unsigned,Window> m_windows;
+};
+
+}
+
+#endif
@@ -0,0 +1,74 @@
+#ifndef Monopoles_MonoAlgorithms_MonoHcalIsoGrid_h
+#define Monopoles_MonoAlgorithms_MonoHcalIsoGrid_h
+
+////////////////////////////////////
+// HBHE energy of an event on an
+// eta-phi grid with a summed-area
+// table, for the HCAL isolation of
+// many clusters: a square annulus is
+// a handful of table lookups, a cone
+// annulus a few per eta row inside
+// it.  Bins count by their centre, so
+// sums agree with EgammaHcalIsolation
+// up to the hits near the cone edges.
+// Phi wraps around.
+////////////////////////////////////
+
+#include "DataFormats/HcalRecHit/interface/HcalRecHitCollections.h"
+
+#include <vector>
+
+class CaloGeometry;
+
+namespace Mono {
+
+class MonoHcalIsoGrid {
+
+public:
+
+  // bins of half an HCAL tower by default
+  MonoHcalIsoGrid(double etaMax=3.0, unsigned nEta=138, unsigned nPhi=144);
+
+  inline virtual ~MonoHcalIsoGrid() { }
+
+  // the HBHE hits above the thresholds of EgammaHcalIsolation, at
+  // their cell positions; builds the table
+  void fill(const HBHERecHitCollection &hits, const CaloGeometry &geom
+    ,double eLowB, double eLowE, double etLowB, double etLowE);
+
+  // or by hand: clear, add, build
+  void clear();
+  void add(double eta, double phi, double energy);
+  void build();
+
+  // energy of the bins with inner <= dR < outer of (eta, phi)
+  double cone(double eta, double phi, double outer, double inner) const;
+
+  // energy of the bins with |deta|, |dphi| < outer but not both < inner
+  double square(double eta, double phi, double outer, double inner) const;
+
+  inline unsigned nEta() const { return m_nEta; }
+  inline unsigned nPhi() const { return m_nPhi; }
+  inline double etaWidth() const { return m_etaWidth; }
+  inline double phiWidth() const { return m_phiWidth; }
+
+private:
+
+  // bins [i0,i1] x [j0,j1], eta clamped to the grid, phi modulo nPhi
+  double rect(int i0, int i1, int j0, int j1) const;
+
+  // the bin range with centres within (x-half, x+half)
+  void range(double x, double half, double min, double width, int &first, int &last) const;
+
+  double m_etaMax;
+  unsigned m_nEta, m_nPhi;
+  double m_etaWidth, m_phiWidth;
+
+  std::vector<double> m_energy;
+  // m_sum[(i+1)*(nPhi+1)+j+1]: energy of bins [0,i] x [0,j]
+  std::vector<double> m_sum;
+};
+
+}
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef Monopoles_MonoAlgorithms_MonoStripAmplitudes_h
+#define Monopoles_MonoAlgorithms_MonoStripAmplitudes_h
+
+////////////////////////////////////
+// Strip count, saturated strip count
+// and ADC sum of the strip cluster
+// behind a tracker rechit.
+////////////////////////////////////
+
+#include <stdint.h>
+
+class TrackingRecHit;
+
+namespace Mono {
+
+// ADC value at and above which a strip is counted as saturated
+const unsigned StripSaturation = 254;
+
+struct StripAmplitudes {
+
+  enum HitType { kOther=0, kStrip, kPixel };
+
+  inline StripAmplitudes()
+    :type(kOther),strips(0),saturated(0),charge(0)
+  { }
+
+  HitType type;
+  unsigned strips;
+  unsigned saturated;
+  unsigned charge;
+};
+
+// sum, count and count >= threshold of n byte amplitudes, added to res
+void sumStripAmplitudes(unsigned n, const uint8_t *ampls, StripAmplitudes &res
+  ,unsigned threshold=StripSaturation);
+
+// resolve the cluster of a strip hit (stereo cluster for matched hits)
+// and fill res; res.type is kPixel or kOther without a strip cluster
+void getStripAmplitudes(const TrackingRecHit *hit, StripAmplitudes &res
+  ,unsigned threshold=StripSaturation);
+
+}
+
+#endif
@@ -31,10 +31,30 @@ public:
   inline double phiVr(double p0, double p1, double p2, double r)
     { return p1-asin( (r*r-p0*p2)/(2*r*(p2-p0)) ); }
 
-  // extrapolate to a specified Z value
+  // extrapolate to a specified Z value, returns the smallest
+  // positive r of the RZ parabola at z, -1 if it never gets there
   // function arguments:
   // fit par0, par1, par2, z
-  inline double rVz(double p0, double p1, double p2, double z) { return -1; }
+  inline double rVz(double p0, double p1, double p2, double z)
+  {
+    // p2 r^2 + p1 r + (p0-z) = 0
+    const double c = p0-z;
+    if ( std::fabs(p2*c) < 1e-9*p1*p1 ) {
+      if ( p1 == 0. ) return -1;
+      const double r = -c/p1;
+      return r > 0. ? r : -1;
+    }
+
+    const double disc = p1*p1-4.*p2*c;
+    if ( disc < 0. ) return -1;
+
+    // roots without cancellation
+    const double q = -0.5*(p1 + (p1 < 0. ? -1. : 1.)*std::sqrt(disc));
+    const double r1 = q/p2;
+    const double r2 = q != 0. ? c/q : -1;
+    if ( r1 > 0. && (r2 <= 0. || r1 < r2) ) return r1;
+    return r2 > 0. ? r2 : -1;
+  }
 
   // find eta from z and r
   inline double eta(double z, double r) 
@@ -13,6 +13,8 @@
 #include "Monopoles/MonoAlgorithms/interface/MonoTrack.h"
 #include "Monopoles/MonoAlgorithms/interface/MonoEcalObs0.h"
 
+#include <vector>
+
 namespace reco {
 class CaloCluster;
 }
@@ -28,6 +30,18 @@ public:
 
   inline virtual ~MonoTrackMatcher() { }
 
+  // where a track meets the Ecal barrel cylinder or the first
+  // endcap plane its RZ parabola reaches; not valid if the
+  // extrapolation gives no finite eta, phi
+  struct Impact {
+    double eta, phi;
+    bool valid;
+  };
+
+  // the impact points of all tracks, once per event and surface
+  static void extrapolate(unsigned nTracks, const MonoTrack *tracks
+    ,const bool isBarrel, std::vector<Impact> &impacts);
+
   // match
   void match(unsigned nClusters, const MonoEcalCluster *clusters
     ,const EBmap &map
@@ -39,6 +53,11 @@ public:
     ,std::vector<int> &matchMap, std::vector<double> &distances
     ,const bool isBarrel=true);
 
+  // to the impact points from extrapolate()
+  void match(unsigned nClusters, const reco::CaloCluster **clusters
+    ,const std::vector<Impact> &impacts
+    ,std::vector<int> &matchMap, std::vector<double> &distances);
+
 
   class MatchInfo {
     public:
@@ -68,8 +87,9 @@ public:
 private:
   inline MonoTrackMatcher() { }
 
+  // Ecal barrel radius and endcap |z|, in cm as the track fits
   static constexpr double s_ecalRad = 129.;
-  static constexpr double s_EEz = 3.144;
+  static constexpr double s_EEz = 314.4;
 
   double m_dRcut;
   
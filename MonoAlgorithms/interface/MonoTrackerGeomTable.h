@@ -0,0 +1,126 @@
+#ifndef Monopoles_MonoAlgorithms_MonoTrackerGeomTable_h
+#define Monopoles_MonoAlgorithms_MonoTrackerGeomTable_h
+
+////////////////////////////////////
+// Flat table of the tracker modules:
+// dE/dx normalisation, thickness, type
+// and surface frame per DetId, behind
+// an open-addressing rawId -> index hash.
+// shared() builds one immutable table
+// per tracker geometry IOV and set of
+// MeV/ADC constants, under a lock, and
+// hands it out to all the modules and
+// streams of the job; an event keeps its
+// table alive across an IOV change.
+////////////////////////////////////
+
+#include "FWCore/Framework/interface/ESHandle.h"
+#include "Geometry/TrackerGeometryBuilder/interface/TrackerGeometry.h"
+
+#include <boost/shared_ptr.hpp>
+
+#include <vector>
+
+namespace edm {
+class EventSetup;
+}
+
+namespace Mono {
+
+class MonoTrackerGeomTable {
+
+public:
+
+  enum ModuleType { kOther=0, kStrip, kPixel };
+
+  struct Module {
+    unsigned rawId;
+    ModuleType type;
+    float thickness;
+    float norm;      // MeV/ADC over the thickness, 0 for non-unit dets
+    float rot[9];    // surface rotation, rows xx xy xz / yx yy yz / zx zy zz
+    float pos[3];    // surface position
+    const GeomDet *det;
+  };
+
+  typedef boost::shared_ptr<const MonoTrackerGeomTable> SharedPtr;
+
+  MonoTrackerGeomTable(double mevPerADCPixel, double mevPerADCStrip);
+
+  inline virtual ~MonoTrackerGeomTable() { }
+
+  // the job-wide table for these constants and the current geometry,
+  // safe to call from concurrent events
+  static SharedPtr shared(const edm::EventSetup &es
+    ,double mevPerADCPixel, double mevPerADCStrip);
+
+  // rebuild if the tracker geometry changed, returns true if it did
+  bool update(const edm::EventSetup &es);
+
+  // index of the module, -1 for an unknown id
+  inline int index(unsigned rawId) const
+  {
+    if ( m_keys.empty() || rawId == 0 ) return -1;
+    for ( unsigned slot = hash(rawId); ; slot = (slot+1) & m_mask ) {
+      if ( m_keys[slot] == rawId ) return m_values[slot];
+      if ( m_keys[slot] == 0 ) return -1;
+    }
+  }
+
+  inline unsigned size() const { return m_modules.size(); }
+  inline const Module & module(unsigned idx) const { return m_modules[idx]; }
+
+  // norm factor of a module, 0 if unknown
+  inline float norm(unsigned rawId) const
+  {
+    const int idx = index(rawId);
+    return idx < 0 ? 0.f : m_modules[idx].norm;
+  }
+
+  // local to global point in the module frame
+  inline void toGlobal(unsigned idx, float lx, float ly, float lz
+    ,float &gx, float &gy, float &gz) const
+  {
+    const Module &m = m_modules[idx];
+    gx = m.pos[0] + m.rot[0]*lx + m.rot[3]*ly + m.rot[6]*lz;
+    gy = m.pos[1] + m.rot[1]*lx + m.rot[4]*ly + m.rot[7]*lz;
+    gz = m.pos[2] + m.rot[2]*lx + m.rot[5]*ly + m.rot[8]*lz;
+  }
+
+  // global to local direction, local z is along the module normal
+  inline void toLocalDirection(unsigned idx, float gx, float gy, float gz
+    ,float &lx, float &ly, float &lz) const
+  {
+    const Module &m = m_modules[idx];
+    lx = m.rot[0]*gx + m.rot[1]*gy + m.rot[2]*gz;
+    ly = m.rot[3]*gx + m.rot[4]*gy + m.rot[5]*gz;
+    lz = m.rot[6]*gx + m.rot[7]*gy + m.rot[8]*gz;
+  }
+
+private:
+
+  inline unsigned hash(unsigned rawId) const
+  {
+    return (rawId * 2654435761u) >> m_shift & m_mask;
+  }
+
+  void insert(unsigned rawId, int idx);
+
+  double m_mevPerADCPixel;
+  double m_mevPerADCStrip;
+
+  unsigned long long m_cacheId;
+  edm::ESHandle<TrackerGeometry> m_geom;
+
+  std::vector<Module> m_modules;
+
+  // hash slots: rawId (0 = empty) and module index
+  std::vector<unsigned> m_keys;
+  std::vector<int> m_values;
+  unsigned m_mask;
+  unsigned m_shift;
+};
+
+}
+
+#endif
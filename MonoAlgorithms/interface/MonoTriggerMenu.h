@@ -0,0 +1,105 @@
+#ifndef Monopoles_MonoAlgorithms_MonoTriggerMenu_h
+#define Monopoles_MonoAlgorithms_MonoTriggerMenu_h
+
+////////////////////////////////////
+// Reader of the HLT menus written by
+// MonoNtupleDumper.  The ntuple keeps
+// one "triggerMenus" entry per menu
+// (run it was first seen in, table
+// name, path names) and per event only
+// the menu id ("trigMenu") and the
+// accept bits ("trigBits", 64 paths a
+// word, path i in word i/64, bit i%64).
+// Resolve the paths of interest once
+// per menu, then test bits per event.
+// ROOT only, for standalone programs.
+////////////////////////////////////
+
+#include "TFile.h"
+#include "TTree.h"
+
+#include <vector>
+#include <string>
+
+namespace Mono {
+
+class MonoTriggerMenu {
+
+public:
+
+  explicit MonoTriggerMenu(TFile &file, const char *treeName="triggerMenus")
+  {
+    TTree *tree = (TTree*)file.Get(treeName);
+    if ( !tree ) return;
+
+    unsigned run = 0;
+    std::string *table = 0;
+    std::vector<std::string> *names = 0;
+    tree->SetBranchAddress("run",&run);
+    tree->SetBranchAddress("tableName",&table);
+    tree->SetBranchAddress("names",&names);
+
+    // entries are in menu id order
+    const unsigned nMenus = tree->GetEntries();
+    for ( unsigned m=0; m != nMenus; m++ ) {
+      tree->GetEntry(m);
+      m_runs.push_back(run);
+      m_tables.push_back(*table);
+      m_names.push_back(*names);
+    }
+
+    tree->ResetBranchAddresses();
+    delete table;
+    delete names;
+  }
+
+  inline unsigned size() const { return m_names.size(); }
+
+  inline unsigned run(unsigned menu) const { return m_runs[menu]; }
+  inline const std::string & table(unsigned menu) const { return m_tables[menu]; }
+  inline const std::vector<std::string> & names(unsigned menu) const { return m_names[menu]; }
+
+  // bit of the path called name, -1 if not in the menu
+  int bit(unsigned menu, const std::string &name) const
+  {
+    const std::vector<std::string> &names = m_names[menu];
+    for ( unsigned i=0; i != names.size(); i++ )
+      if ( names[i] == name ) return i;
+    return -1;
+  }
+
+  // bits of the paths whose name contains pattern
+  std::vector<unsigned> find(unsigned menu, const std::string &pattern) const
+  {
+    std::vector<unsigned> bits;
+    const std::vector<std::string> &names = m_names[menu];
+    for ( unsigned i=0; i != names.size(); i++ )
+      if ( names[i].find(pattern) != std::string::npos ) bits.push_back(i);
+    return bits;
+  }
+
+  static inline bool accept(const std::vector<ULong64_t> &bits, unsigned bit)
+  {
+    return bit/64 < bits.size() && (bits[bit/64] >> (bit%64) & 1);
+  }
+
+  // pack accept flags the way MonoNtupleDumper writes them
+  static inline void set(std::vector<ULong64_t> &bits, unsigned bit)
+  {
+    bits[bit/64] |= ULong64_t(1) << (bit%64);
+  }
+
+  static inline unsigned words(unsigned nPaths) { return (nPaths+63)/64; }
+
+private:
+
+  std::vector<unsigned> m_runs;
+  std::vector<std::string> m_tables;
+  std::vector<std::vector<std::string> > m_names;
+
+};
+
+} // end Mono namespace
+
+
+#endif
@@ -0,0 +1,157 @@
+#include "Monopoles/MonoAlgorithms/interface/MonoAsyncTreeWriter.h"
+
+#include "FWCore/Utilities/interface/Exception.h"
+
+#include "TLeaf.h"
+#include "TObjArray.h"
+#include "TThread.h"
+
+#include <algorithm>
+
+namespace Mono {
+
+
+struct MonoAsyncTreeWriter::Runner {
+  MonoAsyncTreeWriter *writer;
+  void operator()() const { writer->run(); }
+};
+
+
+MonoAsyncTreeWriter::MonoAsyncTreeWriter(unsigned depth)
+  :m_depth(depth),m_tree(0),m_thread(0),m_entries(0)
+{
+  m_stallWatch.Reset();
+  m_writeWatch.Reset();
+}
+
+
+MonoAsyncTreeWriter::~MonoAsyncTreeWriter()
+{
+  stop();
+
+  std::map<std::string,ColumnBase *>::iterator bound = m_bound.begin();
+  for ( ; bound != m_bound.end(); bound++ )
+    if ( std::find(m_columns.begin(),m_columns.end(),bound->second) == m_columns.end() ) delete bound->second;
+  for ( unsigned i=0; i != m_columns.size(); i++ ) delete m_columns[i];
+}
+
+
+MonoAsyncTreeWriter::ColumnBase * MonoAsyncTreeWriter::column(TBranch *branch, unsigned depth)
+{
+  TBranchElement *element = dynamic_cast<TBranchElement*>(branch);
+  if ( element ) {
+    const std::string type = element->GetClassName();
+    if ( type == "vector<double>" ) return new Column<std::vector<double> >(depth);
+    if ( type == "vector<float>" ) return new Column<std::vector<float> >(depth);
+    if ( type == "vector<int>" ) return new Column<std::vector<int> >(depth);
+    if ( type == "vector<unsigned int>" ) return new Column<std::vector<unsigned> >(depth);
+    if ( type == "vector<bool>" ) return new Column<std::vector<bool> >(depth);
+    if ( type == "vector<ULong64_t>" || type == "vector<unsigned long long>" )
+      return new Column<std::vector<ULong64_t> >(depth);
+    if ( type == "vector<string>" ) return new Column<std::vector<std::string> >(depth);
+    return 0;
+  }
+
+  TObjArray *leaves = branch->GetListOfLeaves();
+  if ( leaves->GetEntries() != 1 || ((TLeaf*)leaves->At(0))->GetLen() != 1 ) return 0;
+
+  const std::string type = ((TLeaf*)leaves->At(0))->GetTypeName();
+  if ( type == "Double_t" ) return new Column<double>(depth);
+  if ( type == "Float_t" ) return new Column<float>(depth);
+  if ( type == "Int_t" ) return new Column<int>(depth);
+  if ( type == "UInt_t" ) return new Column<unsigned>(depth);
+  if ( type == "Bool_t" ) return new Column<bool>(depth);
+  if ( type == "ULong64_t" ) return new Column<ULong64_t>(depth);
+  return 0;
+}
+
+
+void MonoAsyncTreeWriter::start(TTree *tree)
+{
+  m_tree = tree;
+  if ( m_depth == 0 ) return;
+
+  TObjArray *branches = tree->GetListOfBranches();
+  for ( int i=0; i != branches->GetEntries(); i++ ) {
+    TBranch *branch = (TBranch*)branches->At(i);
+
+    std::map<std::string,ColumnBase *>::iterator bound = m_bound.find(branch->GetName());
+    ColumnBase *col = bound != m_bound.end() ? bound->second : column(branch,m_depth);
+    if ( !col )
+      throw cms::Exception("Configuration") << "MonoAsyncTreeWriter cannot copy branch " << branch->GetName()
+                                            << " of " << tree->GetName() << ", bind its type first";
+
+    col->attach(tree,branch);
+    m_columns.push_back(col);
+  }
+
+  // autosave changes gDirectory, which the event thread uses
+  tree->SetAutoSave(0);
+
+  m_free.set_capacity(m_depth);
+  m_full.set_capacity(m_depth+1);
+  for ( unsigned s=0; s != m_depth; s++ ) m_free.push(s);
+
+  // ROOT's global locks, before a second thread uses ROOT
+  TThread::Initialize();
+
+  Runner runner = { this };
+  m_thread = new tbb::tbb_thread(runner);
+}
+
+
+void MonoAsyncTreeWriter::fill()
+{
+  m_entries++;
+
+  if ( !m_thread ) {
+    m_writeWatch.Start(kFALSE);
+    m_tree->Fill();
+    m_writeWatch.Stop();
+    return;
+  }
+
+  int slot;
+  if ( !m_free.try_pop(slot) ) {
+    m_stallWatch.Start(kFALSE);
+    m_free.pop(slot);
+    m_stallWatch.Stop();
+  }
+
+  for ( unsigned i=0; i != m_columns.size(); i++ ) m_columns[i]->save(slot);
+  m_full.push(slot);
+}
+
+
+void MonoAsyncTreeWriter::run()
+{
+  for ( ;; ) {
+    int slot;
+    m_full.pop(slot);
+    if ( slot < 0 ) return;
+
+    m_writeWatch.Start(kFALSE);
+    for ( unsigned i=0; i != m_columns.size(); i++ ) m_columns[i]->load(slot);
+    m_tree->Fill();
+    m_writeWatch.Stop();
+
+    m_free.push(slot);
+  }
+}
+
+
+void MonoAsyncTreeWriter::stop()
+{
+  if ( !m_thread ) return;
+
+  m_full.push(-1);
+  m_thread->join();
+  delete m_thread;
+  m_thread = 0;
+
+  // the branches read the analyzer's members again
+  for ( unsigned i=0; i != m_columns.size(); i++ ) m_columns[i]->detach();
+}
+
+
+}
@@ -0,0 +1,96 @@
+#include "Monopoles/MonoAlgorithms/interface/MonoDeDxSignificance.h"
+
+#include "FWCore/Utilities/interface/Exception.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Mono {
+
+
+// ln(e^a + e^b)
+static inline double logAdd(double a, double b)
+{
+  if ( a < b ) std::swap(a,b);
+  if ( b == -HUGE_VAL ) return a;
+  return a + log1p(exp(b-a));
+}
+
+
+MonoDeDxSignificance::MonoDeDxSignificance(double prob, unsigned maxHits)
+  :m_prob(0.),m_maxHits(0)
+{
+  setup(prob,maxHits);
+}
+
+
+void MonoDeDxSignificance::setup(double prob, unsigned maxHits)
+{
+  if ( !(prob > 0. && prob < 1.) )
+    throw cms::Exception("Configuration") << "MonoDeDxSignificance probability " << prob << " not in (0,1)";
+
+  m_prob = prob;
+  m_maxHits = maxHits;
+  m_table.assign((maxHits+1)*(maxHits+2)/2,0.f);
+
+  const double lp = log(prob);
+  const double lq = log1p(-prob);
+
+  // ln n!
+  std::vector<double> lfact(maxHits+1,0.);
+  for ( unsigned i=2; i <= maxHits; i++ ) lfact[i] = lfact[i-1] + log((double)i);
+
+  std::vector<double> term(maxHits+1), tail(maxHits+2);
+  for ( unsigned n=0; n <= maxHits; n++ ) {
+    for ( unsigned k=0; k <= n; k++ ) term[k] = lfact[n]-lfact[k]-lfact[n-k] + k*lp + (n-k)*lq;
+
+    tail[n+1] = -HUGE_VAL;
+    for ( int k=n; k >= 0; k-- ) tail[k] = logAdd(tail[k+1],term[k]);
+
+    // where the tail is near 1, from the head, which is accurate there
+    double head = -HUGE_VAL;
+    float *row = &m_table[n*(n+1)/2];
+    for ( unsigned k=0; k <= n; k++ ) {
+      const double logP = head < -M_LN2 ? log1p(-exp(head)) : tail[k];
+      row[k] = logP < 0. ? sqrt(-logP) : 0.;
+      head = logAdd(head,term[k]);
+    }
+  }
+}
+
+
+double MonoDeDxSignificance::operator()(int subHits, int satSubHits) const
+{
+  if ( satSubHits <= 0 || subHits <= 0 ) return 0.;
+  // not expected, and BinomialI would give 0
+  if ( satSubHits > subHits ) satSubHits = subHits;
+
+  if ( subHits <= (int)m_maxHits ) return m_table[subHits*(subHits+1)/2+satSubHits];
+
+  const double tail = logTail(m_prob,subHits,satSubHits);
+  return tail < 0. ? sqrt(-tail) : 0.;
+}
+
+
+double MonoDeDxSignificance::logTail(double prob, int n, int k)
+{
+  if ( k <= 0 ) return 0.;
+  if ( k > n ) return -HUGE_VAL;
+
+  const double lp = log(prob);
+  const double lq = log1p(-prob);
+  const double lnFact = lgamma(n+1.);
+
+  // below the mean the tail is near 1: one minus the head instead
+  const bool head = k < n*prob;
+  const int first = head ? 0 : k;
+  const int last = head ? k-1 : n;
+  double sum = -HUGE_VAL;
+  for ( int j=first; j <= last; j++ )
+    sum = logAdd(sum,lnFact-lgamma(j+1.)-lgamma(n-j+1.) + j*lp + (n-j)*lq);
+
+  return head ? log1p(-exp(sum)) : sum;
+}
+
+
+}
@@ -0,0 +1,73 @@
+#include "Monopoles/MonoAlgorithms/interface/MonoEcalGeomTable.h"
+
+#include "FWCore/Framework/interface/EventSetup.h"
+#include "FWCore/Framework/interface/ESHandle.h"
+#include "Geometry/Records/interface/CaloGeometryRecord.h"
+#include "Geometry/CaloGeometry/interface/CaloGeometry.h"
+#include "Geometry/CaloGeometry/interface/CaloSubdetectorGeometry.h"
+#include "Geometry/CaloGeometry/interface/CaloCellGeometry.h"
+#include "DataFormats/EcalDetId/interface/EcalSubdetector.h"
+
+namespace Mono {
+
+
+MonoEcalGeomTable::MonoEcalGeomTable()
+  :m_cacheId(0)
+{ }
+
+
+const MonoEcalGeomTable & MonoEcalGeomTable::shared(const edm::EventSetup &es)
+{
+  static MonoEcalGeomTable table;
+  table.update(es);
+  return table;
+}
+
+
+bool MonoEcalGeomTable::update(const edm::EventSetup &es)
+{
+  const CaloGeometryRecord &record = es.get<CaloGeometryRecord>();
+  if ( !m_cells[kEB].eta.empty() && record.cacheIdentifier() == m_cacheId ) return false;
+
+  m_cacheId = record.cacheIdentifier();
+  fill(es);
+
+  return true;
+}
+
+
+void MonoEcalGeomTable::fill(const edm::EventSetup &es)
+{
+  edm::ESHandle<CaloGeometry> calo;
+  es.get<CaloGeometryRecord>().get(calo);
+
+  const unsigned sizes[kNParts] = { EBDetId::kSizeForDenseIndexing, EEDetId::kSizeForDenseIndexing };
+  const EcalSubdetector subdets[kNParts] = { EcalBarrel, EcalEndcap };
+
+  for ( unsigned p=0; p != kNParts; p++ ) {
+    Cells &cells = m_cells[p];
+
+    // cells without geometry stay at 0
+    cells.eta.assign(sizes[p],0.f);
+    cells.phi.assign(sizes[p],0.f);
+    cells.x.assign(sizes[p],0.f);
+    cells.y.assign(sizes[p],0.f);
+    cells.z.assign(sizes[p],0.f);
+
+    const CaloSubdetectorGeometry *geom = calo->getSubdetectorGeometry(DetId::Ecal,subdets[p]);
+    const std::vector<DetId> &ids = geom->getValidDetIds(DetId::Ecal,subdets[p]);
+    for ( unsigned i=0; i != ids.size(); i++ ) {
+      const unsigned idx = p == kEB ? EBDetId(ids[i]).hashedIndex() : EEDetId(ids[i]).hashedIndex();
+      const GlobalPoint &pos = geom->getGeometry(ids[i])->getPosition();
+
+      cells.eta[idx] = pos.eta();
+      cells.phi[idx] = pos.phi();
+      cells.x[idx] = pos.x();
+      cells.y[idx] = pos.y();
+      cells.z[idx] = pos.z();
+    }
+  }
+}
+
+
+}
@@ -0,0 +1,188 @@
+#include "Monopoles/MonoAlgorithms/interface/MonoEcalShapeCache.h"
+
+#include "DataFormats/EcalDetId/interface/EBDetId.h"
+#include "DataFormats/EcalDetId/interface/EEDetId.h"
+#include "DataFormats/EcalDetId/interface/EcalSubdetector.h"
+#include "Geometry/CaloTopology/interface/CaloTopology.h"
+#include "Geometry/CaloTopology/interface/CaloSubdetectorTopology.h"
+#include "Geometry/CaloTopology/interface/CaloNavigator.h"
+#include "RecoEcal/EgammaCoreTools/interface/EcalClusterTools.h"
+
+namespace Mono {
+
+
+MonoEcalShapeCache::MonoEcalShapeCache(bool enable)
+  :m_enable(enable),m_topology(0)
+{
+  m_hits[kEB] = m_hits[kEE] = 0;
+
+  if ( m_enable ) {
+    m_energy[kEB].assign(EBDetId::kSizeForDenseIndexing,0.f);
+    m_fraction[kEB].assign(EBDetId::kSizeForDenseIndexing,0.f);
+    m_energy[kEE].assign(EEDetId::kSizeForDenseIndexing,0.f);
+    m_fraction[kEE].assign(EEDetId::kSizeForDenseIndexing,0.f);
+  }
+}
+
+
+void MonoEcalShapeCache::newEvent(const EcalRecHitCollection *ebHits, const EcalRecHitCollection *eeHits
+  ,const CaloTopology *topology)
+{
+  m_hits[kEB] = ebHits;
+  m_hits[kEE] = eeHits;
+  m_topology = topology;
+
+  if ( !m_enable ) return;
+
+  m_windows.clear();
+  fill(kEB,ebHits);
+  fill(kEE,eeHits);
+}
+
+
+void MonoEcalShapeCache::fill(unsigned part, const EcalRecHitCollection *hits)
+{
+  std::vector<float> &energy = m_energy[part];
+  std::vector<int> &filled = m_filled[part];
+
+  // only the entries of the previous event need resetting
+  for ( unsigned i=0; i != filled.size(); i++ ) energy[filled[i]] = 0.f;
+  filled.clear();
+
+  if ( !hits ) return;
+
+  EcalRecHitCollection::const_iterator hit = hits->begin();
+  for ( ; hit != hits->end(); hit++ ) {
+    unsigned hitPart;
+    int idx;
+    if ( !index(hit->id(),hitPart,idx) || hitPart != part ) continue;
+    energy[idx] = hit->energy();
+    filled.push_back(idx);
+  }
+}
+
+
+bool MonoEcalShapeCache::index(const DetId &id, unsigned &part, int &idx)
+{
+  if ( id.det() != DetId::Ecal ) return false;
+
+  if ( id.subdetId() == EcalBarrel ) {
+    part = kEB;
+    idx = EBDetId(id).hashedIndex();
+    return true;
+  }
+  if ( id.subdetId() == EcalEndcap ) {
+    part = kEE;
+    idx = EEDetId(id).hashedIndex();
+    return true;
+  }
+  return false;
+}
+
+
+const MonoEcalShapeCache::Window & MonoEcalShapeCache::window(const DetId &seed)
+{
+  std::map<unsigned,Window>::iterator found = m_windows.find(seed.rawId());
+  if ( found != m_windows.end() ) return found->second;
+
+  Window &w = m_windows[seed.rawId()];
+  index(seed,w.part,w.idx[12]);
+
+  // the same walk as EcalClusterTools::matrixEnergy
+  CaloNavigator<DetId> cursor(seed,m_topology->getSubdetectorTopology(seed));
+  for ( int i=-2; i <= 2; i++ ) {
+    for ( int j=-2; j <= 2; j++ ) {
+      cursor.home();
+      cursor.offsetBy(i,j);
+
+      const unsigned k = (i+2)*5+j+2;
+      unsigned part;
+      if ( *cursor == DetId(0) || !index(*cursor,part,w.idx[k]) || part != w.part ) {
+	w.idx[k] = -1;
+	w.energy[k] = 0.f;
+      } else
+	w.energy[k] = m_energy[part][w.idx[k]];
+    }
+  }
+
+  return w;
+}
+
+
+MonoEcalShapeCache::Shape MonoEcalShapeCache::shape(const reco::BasicCluster &cluster, bool sides)
+{
+  Shape s = { 0.f, 0.f, 0.f, 0.f, 0.f, 0.f };
+
+  const std::vector<std::pair<DetId,float> > &hits = cluster.hitsAndFractions();
+  if ( hits.empty() ) return s;
+
+  if ( !m_enable ) {
+    unsigned part;
+    int idx;
+    if ( !index(hits[0].first,part,idx) ) return s;
+    const EcalRecHitCollection *recHits = m_hits[part];
+
+    EcalClusterTools ecalTool;
+    s.e55 = ecalTool.e5x5(cluster,recHits,m_topology);
+    s.e51 = ecalTool.e5x1(cluster,recHits,m_topology);
+    s.e15 = ecalTool.e1x5(cluster,recHits,m_topology);
+    s.eMax = ecalTool.eMax(cluster,recHits);
+    if ( sides ) {
+      s.e25Right = ecalTool.e2x5Right(cluster,recHits,m_topology);
+      s.e25Left = ecalTool.e2x5Left(cluster,recHits,m_topology);
+    }
+    return s;
+  }
+
+  // seed as EcalClusterTools::getMaximum: largest energy times fraction
+  DetId seed(0);
+  for ( unsigned h=0; h != hits.size(); h++ ) {
+    unsigned part;
+    int idx;
+    if ( !index(hits[h].first,part,idx) ) continue;
+    const float energy = m_energy[part][idx]*hits[h].second;
+    if ( energy > s.eMax ) {
+      s.eMax = energy;
+      seed = hits[h].first;
+    }
+  }
+  if ( seed == DetId(0) ) return s;
+
+  const Window &w = window(seed);
+
+  // crystals outside the cluster count with fraction 0; the last of
+  // duplicated crystals wins, as in EcalClusterTools::getFraction
+  std::vector<float> &fraction = m_fraction[w.part];
+  for ( unsigned h=0; h != hits.size(); h++ ) {
+    unsigned part;
+    int idx;
+    if ( index(hits[h].first,part,idx) && part == w.part ) fraction[idx] = hits[h].second;
+  }
+
+  float cell[25];
+  for ( unsigned k=0; k != 25; k++ )
+    cell[k] = w.idx[k] < 0 ? 0.f : w.energy[k]*fraction[w.idx[k]];
+
+  for ( unsigned h=0; h != hits.size(); h++ ) {
+    unsigned part;
+    int idx;
+    if ( index(hits[h].first,part,idx) && part == w.part ) fraction[idx] = 0.f;
+  }
+
+  // summed in the order of EcalClusterTools::matrixEnergy
+  for ( int i=-2; i <= 2; i++ ) {
+    for ( int j=-2; j <= 2; j++ ) {
+      const float e = cell[(i+2)*5+j+2];
+      s.e55 += e;
+      if ( j == 0 ) s.e51 += e;
+      if ( i == 0 ) s.e15 += e;
+      if ( i > 0 ) s.e25Right += e;
+      if ( i < 0 ) s.e25Left += e;
+    }
+  }
+
+  return s;
+}
+
+
+}
@@ -0,0 +1,137 @@
+#include "Monopoles/MonoAlgorithms/interface/MonoHcalIsoGrid.h"
+
+#include "Geometry/CaloGeometry/interface/CaloGeometry.h"
+#include "DataFormats/HcalDetId/interface/HcalDetId.h"
+#include "DataFormats/HcalDetId/interface/HcalSubdetector.h"
+
+#include <cmath>
+
+namespace Mono {
+
+
+MonoHcalIsoGrid::MonoHcalIsoGrid(double etaMax, unsigned nEta, unsigned nPhi)
+  :m_etaMax(etaMax),m_nEta(nEta),m_nPhi(nPhi)
+  ,m_etaWidth(2.*etaMax/nEta),m_phiWidth(2.*M_PI/nPhi)
+  ,m_energy(nEta*nPhi,0.),m_sum((nEta+1)*(nPhi+1),0.)
+{ }
+
+
+void MonoHcalIsoGrid::fill(const HBHERecHitCollection &hits, const CaloGeometry &geom
+  ,double eLowB, double eLowE, double etLowB, double etLowE)
+{
+  clear();
+
+  HBHERecHitCollection::const_iterator hit = hits.begin();
+  for ( ; hit != hits.end(); hit++ ) {
+    const bool barrel = HcalDetId(hit->id()).subdet() == HcalBarrel;
+    const double energy = hit->energy();
+    if ( energy <= (barrel ? eLowB : eLowE) ) continue;
+
+    const GlobalPoint pos = geom.getPosition(hit->id());
+    const double et = energy*sin(pos.theta());
+    if ( et <= (barrel ? etLowB : etLowE) ) continue;
+
+    add(pos.eta(),pos.phi(),energy);
+  }
+
+  build();
+}
+
+
+void MonoHcalIsoGrid::clear()
+{
+  m_energy.assign(m_energy.size(),0.);
+}
+
+
+void MonoHcalIsoGrid::add(double eta, double phi, double energy)
+{
+  const int i = (int)std::floor((eta+m_etaMax)/m_etaWidth);
+  if ( i < 0 || i >= (int)m_nEta ) return;
+
+  int j = (int)std::floor((phi+M_PI)/m_phiWidth);
+  j = (j%(int)m_nPhi + m_nPhi) % m_nPhi;
+
+  m_energy[i*m_nPhi+j] += energy;
+}
+
+
+void MonoHcalIsoGrid::build()
+{
+  const unsigned stride = m_nPhi+1;
+  for ( unsigned i=0; i != m_nEta; i++ ) {
+    double row = 0.;
+    for ( unsigned j=0; j != m_nPhi; j++ ) {
+      row += m_energy[i*m_nPhi+j];
+      m_sum[(i+1)*stride+j+1] = m_sum[i*stride+j+1] + row;
+    }
+  }
+}
+
+
+double MonoHcalIsoGrid::rect(int i0, int i1, int j0, int j1) const
+{
+  if ( i0 < 0 ) i0 = 0;
+  if ( i1 >= (int)m_nEta ) i1 = m_nEta-1;
+  if ( i0 > i1 || j0 > j1 ) return 0.;
+
+  // the whole ring, or the part past either end of phi separately
+  const int n = m_nPhi;
+  if ( j1-j0+1 >= n ) { j0 = 0; j1 = n-1; }
+  else if ( j0 < 0 ) return rect(i0,i1,j0+n,n-1) + rect(i0,i1,0,j1);
+  else if ( j1 >= n ) return rect(i0,i1,j0,n-1) + rect(i0,i1,0,j1-n);
+
+  const unsigned stride = m_nPhi+1;
+  return m_sum[(i1+1)*stride+j1+1] - m_sum[i0*stride+j1+1]
+       - m_sum[(i1+1)*stride+j0] + m_sum[i0*stride+j0];
+}
+
+
+void MonoHcalIsoGrid::range(double x, double half, double min, double width, int &first, int &last) const
+{
+  // bin b has its centre at min+(b+0.5)*width
+  first = (int)std::floor((x-half-min)/width - 0.5) + 1;
+  last = (int)std::ceil((x+half-min)/width - 0.5) - 1;
+}
+
+
+double MonoHcalIsoGrid::cone(double eta, double phi, double outer, double inner) const
+{
+  int i0, i1;
+  range(eta,outer,-m_etaMax,m_etaWidth,i0,i1);
+  if ( i0 < 0 ) i0 = 0;
+  if ( i1 >= (int)m_nEta ) i1 = m_nEta-1;
+
+  double sum = 0.;
+  for ( int i=i0; i <= i1; i++ ) {
+    const double dEta = -m_etaMax + (i+0.5)*m_etaWidth - eta;
+    int j0, j1;
+    range(phi,std::sqrt(outer*outer-dEta*dEta),-M_PI,m_phiWidth,j0,j1);
+    sum += rect(i,i,j0,j1);
+
+    if ( std::fabs(dEta) < inner ) {
+      range(phi,std::sqrt(inner*inner-dEta*dEta),-M_PI,m_phiWidth,j0,j1);
+      sum -= rect(i,i,j0,j1);
+    }
+  }
+
+  return sum;
+}
+
+
+double MonoHcalIsoGrid::square(double eta, double phi, double outer, double inner) const
+{
+  int i0, i1, j0, j1;
+  range(eta,outer,-m_etaMax,m_etaWidth,i0,i1);
+  range(phi,outer,-M_PI,m_phiWidth,j0,j1);
+  double sum = rect(i0,i1,j0,j1);
+
+  range(eta,inner,-m_etaMax,m_etaWidth,i0,i1);
+  range(phi,inner,-M_PI,m_phiWidth,j0,j1);
+  sum -= rect(i0,i1,j0,j1);
+
+  return sum;
+}
+
+
+}
@@ -0,0 +1,111 @@
+#include "Monopoles/MonoAlgorithms/interface/MonoStripAmplitudes.h"
+
+#include "DataFormats/TrackerRecHit2D/interface/SiStripRecHit2D.h"
+#include "DataFormats/TrackerRecHit2D/interface/SiStripMatchedRecHit2D.h"
+#include "DataFormats/TrackerRecHit2D/interface/SiPixelRecHit.h"
+#include "DataFormats/TrackerRecHit2D/interface/ProjectedSiStripRecHit2D.h"
+#include "DataFormats/TrackerRecHit2D/interface/SiStripRecHit1D.h"
+
+#include "RecoTracker/DeDx/interface/DeDxTools.h"
+
+#include <typeinfo>
+#include <vector>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace Mono {
+
+void sumStripAmplitudes(const unsigned n, const uint8_t *ampls, StripAmplitudes &res
+  ,const unsigned threshold)
+{
+  res.strips += n;
+  if ( threshold > 255 ) {
+    for ( unsigned i=0; i != n; i++ ) res.charge += ampls[i];
+    return;
+  }
+
+  unsigned i = 0;
+  unsigned charge = 0, saturated = 0;
+
+#ifdef __SSE2__
+  // a >= threshold  <=>  max(a,threshold) == a
+  const __m128i thresh = _mm_set1_epi8((char)threshold);
+  const __m128i zero = _mm_setzero_si128();
+
+  // 16 strips at a time: sum of absolute differences to 0 gives the
+  // byte sums of each half, the saturation mask is counted with popcount
+  for ( ; i+16 <= n; i += 16 ) {
+    const __m128i a = _mm_loadu_si128((const __m128i *)(ampls+i));
+    const __m128i sad = _mm_sad_epu8(a,zero);
+    charge += _mm_cvtsi128_si32(sad) + _mm_cvtsi128_si32(_mm_srli_si128(sad,8));
+    const __m128i sat = _mm_cmpeq_epi8(_mm_max_epu8(a,thresh),a);
+    saturated += __builtin_popcount(_mm_movemask_epi8(sat));
+  }
+
+  // typical clusters are short, one 8 strip block before the scalar tail
+  if ( i+8 <= n ) {
+    const __m128i a = _mm_loadl_epi64((const __m128i *)(ampls+i));
+    charge += _mm_cvtsi128_si32(_mm_sad_epu8(a,zero));
+    const __m128i sat = _mm_cmpeq_epi8(_mm_max_epu8(a,thresh),a);
+    saturated += __builtin_popcount(_mm_movemask_epi8(sat) & 0xff);
+    i += 8;
+  }
+#endif
+
+  for ( ; i != n; i++ ) {
+    charge += ampls[i];
+    saturated += ampls[i] >= threshold;
+  }
+
+  res.charge += charge;
+  res.saturated += saturated;
+}
+
+
+namespace {
+  inline void addCluster(const std::vector<uint8_t> &ampls, StripAmplitudes &res, unsigned threshold)
+  {
+    res.type = StripAmplitudes::kStrip;
+    if ( !ampls.empty() ) sumStripAmplitudes(ampls.size(),&ampls[0],res,threshold);
+  }
+}
+
+void getStripAmplitudes(const TrackingRecHit *hit, StripAmplitudes &res
+  ,const unsigned threshold)
+{
+  res = StripAmplitudes();
+
+  // persistent hits are always of the leaf types, so one typeid lookup
+  // resolves the common cases without walking a dynamic_cast chain
+  const std::type_info &type = typeid(*hit);
+
+  if ( type == typeid(SiStripMatchedRecHit2D) ) {
+    const SiStripMatchedRecHit2D *matchedHit = static_cast<const SiStripMatchedRecHit2D *>(hit);
+    addCluster(DeDxTools::GetCluster(matchedHit->stereoHit())->amplitudes(),res,threshold);
+  } else if ( type == typeid(SiStripRecHit2D) ) {
+    addCluster(DeDxTools::GetCluster(static_cast<const SiStripRecHit2D *>(hit))->amplitudes(),res,threshold);
+  } else if ( type == typeid(SiStripRecHit1D) ) {
+    addCluster(DeDxTools::GetCluster(static_cast<const SiStripRecHit1D *>(hit))->amplitudes(),res,threshold);
+  } else if ( type == typeid(ProjectedSiStripRecHit2D) ) {
+    const ProjectedSiStripRecHit2D *projectedHit = static_cast<const ProjectedSiStripRecHit2D *>(hit);
+    addCluster(DeDxTools::GetCluster(&(projectedHit->originalHit()))->amplitudes(),res,threshold);
+  } else if ( type == typeid(SiPixelRecHit) ) {
+    res.type = StripAmplitudes::kPixel;
+  }
+  // derived types are not expected, fall back to the casts
+  else if ( const SiStripMatchedRecHit2D *matchedHit = dynamic_cast<const SiStripMatchedRecHit2D *>(hit) ) {
+    addCluster(DeDxTools::GetCluster(matchedHit->stereoHit())->amplitudes(),res,threshold);
+  } else if ( const ProjectedSiStripRecHit2D *projectedHit = dynamic_cast<const ProjectedSiStripRecHit2D *>(hit) ) {
+    addCluster(DeDxTools::GetCluster(&(projectedHit->originalHit()))->amplitudes(),res,threshold);
+  } else if ( const SiStripRecHit2D *singleHit = dynamic_cast<const SiStripRecHit2D *>(hit) ) {
+    addCluster(DeDxTools::GetCluster(singleHit)->amplitudes(),res,threshold);
+  } else if ( const SiStripRecHit1D *single1DHit = dynamic_cast<const SiStripRecHit1D *>(hit) ) {
+    addCluster(DeDxTools::GetCluster(single1DHit)->amplitudes(),res,threshold);
+  } else if ( dynamic_cast<const SiPixelRecHit *>(hit) ) {
+    res.type = StripAmplitudes::kPixel;
+  }
+}
+
+}
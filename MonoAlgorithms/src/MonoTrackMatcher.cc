@@ -90,11 +90,63 @@ void MonoTrackMatcher::match(const unsigned nClusters, const MonoEcalCluster *cl
 }
 
 
+void MonoTrackMatcher::extrapolate(const unsigned nTracks, const MonoTrack *tracks
+  ,const bool isBarrel, std::vector<Impact> &impacts)
+{
+
+  impacts.resize(nTracks);
+
+  MonoTrackExtrapolator extrap;
+
+  const double myInf = log(0);
+
+  for ( unsigned t=0; t != nTracks; t++ ) {
+    const MonoTrack & track = tracks[t];
+    Impact & impact = impacts[t];
+
+    // the barrel cylinder at s_ecalRad, or the endcap plane the RZ
+    // parabola reaches first: a strongly bent track can turn back to
+    // the endcap opposite to its initial slope
+    double z = 0., r = s_ecalRad;
+    if ( isBarrel ) z = extrap.zVr(track.rzp0(),track.rzp1(),track.rzp2(),s_ecalRad);
+    else {
+      const double rPlus = extrap.rVz(track.rzp0(),track.rzp1(),track.rzp2(),s_EEz);
+      const double rMinus = extrap.rVz(track.rzp0(),track.rzp1(),track.rzp2(),-s_EEz);
+      const bool plus = rPlus > 0. && (rMinus <= 0. || rPlus < rMinus);
+      z = plus ? s_EEz : -s_EEz;
+      r = plus ? rPlus : rMinus;
+    }
+    const double teta = extrap.eta(z,r);
+    const double tphi = extrap.phiVr(track.xyp0(),track.xyp1(),track.xyp2(),r);
+
+    // NAN in tphi or teta, or infinite teta, or no crossing never match
+    impact.eta = teta;
+    impact.phi = tphi;
+    impact.valid = r > 0. && tphi == tphi && teta == teta && teta != myInf && teta != -myInf;
+  }
+
+}
+
+
 void MonoTrackMatcher::match(const unsigned nClusters, const reco::CaloCluster **clusters
   ,const unsigned nTracks, const MonoTrack *tracks
   ,std::vector<int> & matchMap, std::vector<double> & distances, const bool isBarrel)
 {
 
+  std::vector<Impact> impacts;
+  extrapolate(nTracks,tracks,isBarrel,impacts);
+  match(nClusters,clusters,impacts,matchMap,distances);
+
+}
+
+
+void MonoTrackMatcher::match(const unsigned nClusters, const reco::CaloCluster **clusters
+  ,const std::vector<Impact> &impacts
+  ,std::vector<int> & matchMap, std::vector<double> & distances)
+{
+
+  const unsigned nTracks = impacts.size();
+
   matchMap.clear();
   distances.clear();
 
@@ -108,12 +160,6 @@ void MonoTrackMatcher::match(const unsigned nClusters, const reco::CaloCluster *
   const unsigned nMatch = nClusters*nTracks;
   std::vector<MatchInfo> matchInfoMap(nMatch);
 
-  MonoTrackExtrapolator extrap;
-
-  unsigned M=0;
-
-  const double myInf = log(0);
-
   // cycle over all pairs of clusters and tracks
   // build map of distances
   for ( unsigned c=0; c != nClusters; c++ ) {
@@ -122,18 +168,10 @@ void MonoTrackMatcher::match(const unsigned nClusters, const reco::CaloCluster *
     const double ceta = clust->eta();
 
     for ( unsigned t=0; t != nTracks; t++ ) {
-      const MonoTrack & track = tracks[t];
-      const double tz = isBarrel ? extrap.zVr(track.rzp0(),track.rzp1(),track.rzp2(),s_ecalRad) : extrap.rVz(track.rzp0(),track.rzp1(),track.rzp2(),s_EEz);
-      const double teta = isBarrel ? extrap.eta(tz,s_ecalRad) : extrap.eta(s_EEz,tz);
-      const double tphi = isBarrel ? extrap.phiVr(track.xyp0(),track.xyp1(),track.xyp2(),s_ecalRad) : extrap.phiVr(track.xyp0(),track.xyp1(),track.xyp2(),tz);
-
-      // check for NAN in tphi
-      // if it is continue default distance is 999
-      if ( tphi != tphi ) continue;
-      if ( teta != teta ) continue;
-      if ( teta == myInf || teta == -myInf ) continue;
+      // if it does not reach the surface the default distance is 999
+      if ( !impacts[t].valid ) continue;
 
-      const double dR = reco::deltaR(cphi,ceta,teta,tphi);
+      const double dR = reco::deltaR(ceta,cphi,impacts[t].eta,impacts[t].phi);
       matchInfoMap[c*nTracks+t] = MatchInfo(dR,c,t);  
 
       assert(matchInfoMap[c*nTracks+t].getic()<nClusters);
@@ -0,0 +1,118 @@
+#include "Monopoles/MonoAlgorithms/interface/MonoTrackerGeomTable.h"
+
+#include "FWCore/Framework/interface/EventSetup.h"
+#include "Geometry/Records/interface/TrackerDigiGeometryRecord.h"
+#include "Geometry/TrackerGeometryBuilder/interface/StripGeomDetUnit.h"
+#include "Geometry/TrackerGeometryBuilder/interface/PixelGeomDetUnit.h"
+
+#include "tbb/mutex.h"
+
+#include <list>
+
+namespace Mono {
+
+
+MonoTrackerGeomTable::MonoTrackerGeomTable(double mevPerADCPixel, double mevPerADCStrip)
+  :m_mevPerADCPixel(mevPerADCPixel),m_mevPerADCStrip(mevPerADCStrip)
+  ,m_cacheId(0),m_mask(0),m_shift(32)
+{ }
+
+
+namespace {
+  // normally a single entry, all the users run with the same constants
+  std::list<MonoTrackerGeomTable::SharedPtr> sharedTables;
+  tbb::mutex sharedMutex;
+}
+
+
+MonoTrackerGeomTable::SharedPtr MonoTrackerGeomTable::shared(const edm::EventSetup &es
+  ,double mevPerADCPixel, double mevPerADCStrip)
+{
+  const unsigned long long cacheId = es.get<TrackerDigiGeometryRecord>().cacheIdentifier();
+
+  tbb::mutex::scoped_lock lock(sharedMutex);
+
+  std::list<SharedPtr>::iterator table = sharedTables.begin();
+  for ( ; table != sharedTables.end(); ++table )
+    if ( (*table)->m_mevPerADCPixel == mevPerADCPixel && (*table)->m_mevPerADCStrip == mevPerADCStrip ) break;
+  if ( table != sharedTables.end() && (*table)->m_cacheId == cacheId ) return *table;
+
+  // new constants or a new IOV: a new table, never one changed in place
+  // under the events still using it
+  MonoTrackerGeomTable *fresh = new MonoTrackerGeomTable(mevPerADCPixel,mevPerADCStrip);
+  SharedPtr ptr(fresh);
+  fresh->update(es);
+
+  if ( table == sharedTables.end() ) sharedTables.push_back(ptr);
+  else *table = ptr;
+  return ptr;
+}
+
+
+bool MonoTrackerGeomTable::update(const edm::EventSetup &es)
+{
+  const TrackerDigiGeometryRecord &record = es.get<TrackerDigiGeometryRecord>();
+  if ( !m_modules.empty() && record.cacheIdentifier() == m_cacheId ) return false;
+
+  m_cacheId = record.cacheIdentifier();
+  record.get(m_geom);
+
+  const std::vector<GeomDet*> &dets = m_geom->dets();
+  const unsigned nDets = dets.size();
+
+  m_modules.resize(nDets);
+  for ( unsigned i=0; i != nDets; i++ ) {
+    const GeomDet *det = dets[i];
+    Module &m = m_modules[i];
+
+    m.rawId = det->geographicalId().rawId();
+    m.det = det;
+    m.thickness = det->surface().bounds().thickness();
+
+    // glued and stacked dets keep a zero norm, as in the old per-module maps
+    if ( dynamic_cast<const StripGeomDetUnit*>(det) ) {
+      m.type = kStrip;
+      m.norm = m_mevPerADCStrip / m.thickness;
+    } else if ( dynamic_cast<const PixelGeomDetUnit*>(det) ) {
+      m.type = kPixel;
+      m.norm = m_mevPerADCPixel / m.thickness;
+    } else {
+      m.type = kOther;
+      m.norm = 0.;
+    }
+
+    const Surface::RotationType &rot = det->surface().rotation();
+    m.rot[0] = rot.xx(); m.rot[1] = rot.xy(); m.rot[2] = rot.xz();
+    m.rot[3] = rot.yx(); m.rot[4] = rot.yy(); m.rot[5] = rot.yz();
+    m.rot[6] = rot.zx(); m.rot[7] = rot.zy(); m.rot[8] = rot.zz();
+
+    const Surface::PositionType &pos = det->surface().position();
+    m.pos[0] = pos.x(); m.pos[1] = pos.y(); m.pos[2] = pos.z();
+  }
+
+  // at most half full
+  unsigned bits = 4;
+  while ( (1u << bits) < 2*nDets ) bits++;
+  m_mask = (1u << bits) - 1;
+  m_shift = 32 - bits;
+  m_keys.assign(m_mask+1,0);
+  m_values.assign(m_mask+1,-1);
+
+  for ( unsigned i=0; i != nDets; i++ ) insert(m_modules[i].rawId,i);
+
+  return true;
+}
+
+
+void MonoTrackerGeomTable::insert(unsigned rawId, int idx)
+{
+  if ( rawId == 0 ) return;
+
+  unsigned slot = hash(rawId);
+  while ( m_keys[slot] != 0 && m_keys[slot] != rawId ) slot = (slot+1) & m_mask;
+  m_keys[slot] = rawId;
+  m_values[slot] = idx;
+}
+
+
+}
@@ -0,0 +1,66 @@
+///////////////////////////////////////////////
+// Check the tabulated dE/dx significance
+// against sqrt(-ln TMath::BinomialI) wherever
+// BinomialI is finite, and its continuity at
+// the maxHits edge of the table, where the
+// tail is summed per call instead.
+//   monoDeDxSignificanceTest [prob] [maxHits]
+///////////////////////////////////////////////
+
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <cmath>
+
+#include "TMath.h"
+
+#include "Monopoles/MonoAlgorithms/interface/MonoDeDxSignificance.h"
+
+
+int main(int argc, char **argv) {
+
+  const double prob = argc > 1 ? atof(argv[1]) : 0.07;
+  const unsigned maxHits = argc > 2 ? atoi(argv[2]) : 1024;
+
+  Mono::MonoDeDxSignificance sig(prob,maxHits);
+
+  // BinomialI: incomplete beta, accurate to about 1e-7 relative, so the
+  // significance is compared to an absolute 1e-3 where P is near 1
+  unsigned nCompared = 0, nUnderflow = 0;
+  double maxDiff = 0.;
+  for ( unsigned n=1; n <= maxHits; n++ ) {
+    for ( unsigned k=1; k <= n; k++ ) {
+      const double p = TMath::BinomialI(prob,n,k);
+      if ( !(p > 1e-280) ) {
+        // where BinomialI gives up the table is still finite and large
+        nUnderflow++;
+        assert( sig(n,k) > 25. );
+        continue;
+      }
+      const double ref = p < 1. ? std::sqrt(-std::log(p)) : 0.;
+      const double diff = std::fabs(sig(n,k) - ref);
+      assert( diff < 1e-3 + 1e-4*ref );
+      if ( diff > maxDiff ) maxDiff = diff;
+      nCompared++;
+    }
+  }
+
+  // the table edge: the last row agrees with the direct sum, and one more
+  // subhit moves the significance the way the binomial tail does
+  const int n = maxHits;
+  for ( int k=1; k <= n; k++ ) {
+    const double tail = Mono::MonoDeDxSignificance::logTail(prob,n,k);
+    const double direct = tail < 0. ? std::sqrt(-tail) : 0.;
+    assert( std::fabs(sig(n,k) - direct) < 1e-5*(1. + direct) );
+
+    // X(n+1) >= k+1 needs X(n) >= k, and X(n) >= k gives X(n+1) >= k
+    assert( sig(n+1,k) <= sig(n,k) + 1e-5*(1. + sig(n,k)) );
+    assert( sig(n+1,k+1) >= sig(n,k) - 1e-5*(1. + sig(n,k)) );
+  }
+
+  std::cout << nCompared << " (n, k) compared to BinomialI, max |diff| " << maxDiff << ", "
+            << nUnderflow << " beyond its range" << std::endl;
+  std::cout << "continuous at the " << maxHits << " subhit table edge" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,157 @@
+///////////////////////////////////////////////
+// Compare the HCAL isolation of MonoHcalIsoGrid
+// with the per-hit sum of EgammaHcalIsolation
+// (inner <= dR < outer) on toy hits at HCAL
+// tower centres.  The grid counts a hit by its
+// bin centre, so the two may only differ by
+// hits within half a bin diagonal of a cone
+// edge; hits put on bin centres agree exactly.
+//   monoHcalIsoGridTest [nEvents] [nHits] [nClusters]
+///////////////////////////////////////////////
+
+#include <vector>
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <cmath>
+#include <ctime>
+
+#include "Monopoles/MonoAlgorithms/interface/MonoHcalIsoGrid.h"
+
+
+double uniform(double lo, double hi) { return lo + (hi-lo)*(rand()+0.5)/(RAND_MAX+1.); }
+
+double deltaPhi(double a, double b)
+{
+  double d = a - b;
+  while ( d > M_PI ) d -= 2*M_PI;
+  while ( d <= -M_PI ) d += 2*M_PI;
+  return d;
+}
+
+struct Hit {
+  double eta, phi, energy;
+};
+
+// the sum of EgammaHcalIsolation: every hit with inner <= dR < outer
+double exactCone(const std::vector<Hit> &hits, double eta, double phi, double outer, double inner
+  ,double edge, double &nearEdge)
+{
+  double sum = 0.;
+  nearEdge = 0.;
+  for ( unsigned h=0; h != hits.size(); h++ ) {
+    const double dEta = hits[h].eta - eta;
+    const double dPhi = deltaPhi(hits[h].phi,phi);
+    const double dR = std::sqrt(dEta*dEta + dPhi*dPhi);
+    if ( dR >= inner && dR < outer ) sum += hits[h].energy;
+    if ( std::fabs(dR-inner) < edge || std::fabs(dR-outer) < edge ) nearEdge += hits[h].energy;
+  }
+  return sum;
+}
+
+double exactSquare(const std::vector<Hit> &hits, double eta, double phi, double outer, double inner)
+{
+  double sum = 0.;
+  for ( unsigned h=0; h != hits.size(); h++ ) {
+    const double dEta = std::fabs(hits[h].eta - eta);
+    const double dPhi = std::fabs(deltaPhi(hits[h].phi,phi));
+    if ( dEta < outer && dPhi < outer && !(dEta < inner && dPhi < inner) ) sum += hits[h].energy;
+  }
+  return sum;
+}
+
+void fillGrid(Mono::MonoHcalIsoGrid &grid, const std::vector<Hit> &hits)
+{
+  grid.clear();
+  for ( unsigned h=0; h != hits.size(); h++ ) grid.add(hits[h].eta,hits[h].phi,hits[h].energy);
+  grid.build();
+}
+
+
+int main(int argc, char **argv) {
+
+  const unsigned nEvents = argc > 1 ? atoi(argv[1]) : 200;
+  const unsigned nHits = argc > 2 ? atoi(argv[2]) : 2000;
+  const unsigned nClusters = argc > 3 ? atoi(argv[3]) : 100;
+
+  // the cone of the dumper
+  const double outer = 0.4, inner = 0.1;
+  // HCAL towers up to |eta| 2.6
+  const double towerEta = 0.087, towerPhi = 2*M_PI/72;
+  const int nTowerEta = 30;
+
+  srand(4357);
+
+  Mono::MonoHcalIsoGrid grid;
+  const double edge = 0.5*std::sqrt(grid.etaWidth()*grid.etaWidth() + grid.phiWidth()*grid.phiWidth()) + 1e-9;
+
+  std::vector<Hit> towers, centres;
+  double maxDiff = 0., maxNearEdge = 0., total = 0.;
+  double gridTime = 0., exactTime = 0.;
+
+  for ( unsigned e=0; e != nEvents; e++ ) {
+
+    // toy HBHE hits on tower centres, mostly soft with a few deposits
+    towers.resize(nHits);
+    for ( unsigned h=0; h != nHits; h++ ) {
+      const int ie = rand()%(2*nTowerEta) - nTowerEta;
+      const int ip = rand()%72;
+      towers[h].eta = (ie+0.5)*towerEta;
+      towers[h].phi = -M_PI + (ip+0.5)*towerPhi;
+      towers[h].energy = rand()%20 ? uniform(0.7,3.) : uniform(3.,100.);
+    }
+
+    // the same hits moved to the centres of their grid bins
+    centres = towers;
+    for ( unsigned h=0; h != nHits; h++ ) {
+      const double w = grid.etaWidth(), v = grid.phiWidth();
+      centres[h].eta = -3.0 + (std::floor((centres[h].eta+3.0)/w)+0.5)*w;
+      centres[h].phi = -M_PI + (std::floor((centres[h].phi+M_PI)/v)+0.5)*v;
+    }
+
+    std::vector<double> etas(nClusters), phis(nClusters);
+    for ( unsigned c=0; c != nClusters; c++ ) {
+      etas[c] = uniform(-2.5,2.5);
+      phis[c] = uniform(-M_PI,M_PI);
+    }
+
+    // bin centres: cone and square sums agree up to rounding
+    fillGrid(grid,centres);
+    for ( unsigned c=0; c != nClusters; c++ ) {
+      double nearEdge;
+      const double cone = exactCone(centres,etas[c],phis[c],outer,inner,edge,nearEdge);
+      assert( std::fabs(grid.cone(etas[c],phis[c],outer,inner) - cone) < 1e-6*(1+cone) );
+      const double square = exactSquare(centres,etas[c],phis[c],outer,inner);
+      assert( std::fabs(grid.square(etas[c],phis[c],outer,inner) - square) < 1e-6*(1+square) );
+    }
+
+    // tower positions: only the hits near the cone edges may differ
+    std::clock_t start = std::clock();
+    fillGrid(grid,towers);
+    std::vector<double> gridSums(nClusters);
+    for ( unsigned c=0; c != nClusters; c++ ) gridSums[c] = grid.cone(etas[c],phis[c],outer,inner);
+    gridTime += double(std::clock()-start)/CLOCKS_PER_SEC;
+
+    start = std::clock();
+    std::vector<double> exactSums(nClusters), nearEdges(nClusters);
+    for ( unsigned c=0; c != nClusters; c++ )
+      exactSums[c] = exactCone(towers,etas[c],phis[c],outer,inner,edge,nearEdges[c]);
+    exactTime += double(std::clock()-start)/CLOCKS_PER_SEC;
+
+    for ( unsigned c=0; c != nClusters; c++ ) {
+      const double diff = std::fabs(gridSums[c] - exactSums[c]);
+      assert( diff <= nearEdges[c] + 1e-6*(1+exactSums[c]) );
+      if ( diff > maxDiff ) maxDiff = diff;
+      if ( nearEdges[c] > maxNearEdge ) maxNearEdge = nearEdges[c];
+      total += exactSums[c];
+    }
+  }
+
+  std::cout << nEvents << " events x " << nClusters << " clusters, " << nHits << " hits/event" << std::endl;
+  std::cout << "exact on bin centres; on towers mean iso " << total/(nEvents*nClusters)
+            << " GeV, max |grid-exact| " << maxDiff << " GeV (edge hits up to " << maxNearEdge << " GeV)" << std::endl;
+  std::cout << "grid " << 1000*gridTime/nEvents << " ms/event, per-hit sum " << 1000*exactTime/nEvents
+            << " ms/event" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,107 @@
+///////////////////////////////////////////////
+// Check the strip amplitude kernel against a
+// plain loop and time both on toy clusters:
+// mostly short MIP clusters with a tail of
+// wide, saturated monopole clusters.
+//   monoStripKernelTest [nClusters] [monopoleFraction]
+///////////////////////////////////////////////
+
+#include <vector>
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <ctime>
+
+#include "Monopoles/MonoAlgorithms/interface/MonoStripAmplitudes.h"
+
+
+// the loop the modules used to repeat for every hit type
+void __attribute__((noinline)) loopAmplitudes(const std::vector<uint8_t> &Ampls, unsigned begin, unsigned end
+  ,int &Strips, int &SatStrips, float &Charge)
+{
+  Strips += end-begin;
+  for ( unsigned i=begin; i != end; i++ ) {
+    Charge += Ampls[i];
+    if ( Ampls[i] >= 254 ) SatStrips++;
+  }
+}
+
+
+int main(int argc, char **argv) {
+
+  const unsigned nClusters = argc > 1 ? atoi(argv[1]) : 1000000;
+  const double monoFraction = argc > 2 ? atof(argv[2]) : 0.05;
+  const unsigned nRepeat = 20;
+
+  srand(4357);
+
+  // all clusters back to back, as the amplitudes of a track's hits
+  std::vector<uint8_t> ampls;
+  std::vector<unsigned> begin(1,0);
+  for ( unsigned c=0; c != nClusters; c++ ) {
+    const bool mono = rand() < monoFraction*RAND_MAX;
+    // MIPs: 1-6 strips, monopoles: 5-60 strips with a saturated core
+    const unsigned size = mono ? 5 + rand()%56 : 1 + rand()%3 + rand()%4;
+    for ( unsigned s=0; s != size; s++ ) {
+      unsigned a = rand()%80;
+      if ( mono && s > 1 && s+2 < size ) a = rand()%4 ? 254 + rand()%2 : 150 + rand()%100;
+      ampls.push_back(a);
+    }
+    begin.push_back(ampls.size());
+  }
+
+  // reference
+  std::clock_t start = std::clock();
+  unsigned long refCharge = 0, refSat = 0, refStrips = 0;
+  for ( unsigned r=0; r != nRepeat; r++ ) {
+    refCharge = refSat = refStrips = 0;
+    for ( unsigned c=0; c != nClusters; c++ ) {
+      int Strips = 0, SatStrips = 0;
+      float Charge = 0;
+      loopAmplitudes(ampls,begin[c],begin[c+1],Strips,SatStrips,Charge);
+      refCharge += (unsigned long)Charge;
+      refSat += SatStrips;
+      refStrips += Strips;
+    }
+  }
+  const double refTime = double(std::clock()-start)/CLOCKS_PER_SEC;
+
+  // kernel, per cluster as it is called on hits
+  start = std::clock();
+  unsigned long charge = 0, sat = 0, strips = 0;
+  for ( unsigned r=0; r != nRepeat; r++ ) {
+    charge = sat = strips = 0;
+    for ( unsigned c=0; c != nClusters; c++ ) {
+      Mono::StripAmplitudes res;
+      Mono::sumStripAmplitudes(begin[c+1]-begin[c],&ampls[begin[c]],res);
+      charge += res.charge;
+      sat += res.saturated;
+      strips += res.strips;
+    }
+  }
+  const double time = double(std::clock()-start)/CLOCKS_PER_SEC;
+
+  assert( charge == refCharge );
+  assert( sat == refSat );
+  assert( strips == refStrips );
+
+  // other thresholds
+  for ( unsigned c=0; c != nClusters && c != 10000; c++ ) {
+    const unsigned thresholds[4] = {0, 100, 255, 256};
+    for ( unsigned t=0; t != 4; t++ ) {
+      Mono::StripAmplitudes res;
+      Mono::sumStripAmplitudes(begin[c+1]-begin[c],&ampls[begin[c]],res,thresholds[t]);
+      unsigned expected = 0;
+      for ( unsigned i=begin[c]; i != begin[c+1]; i++ ) expected += ampls[i] >= thresholds[t];
+      assert( res.saturated == expected );
+    }
+  }
+
+  const double nsPerCluster = 1e9/(double(nClusters)*nRepeat);
+  std::cout << nClusters << " clusters, " << double(refStrips)/nClusters << " strips/cluster" << std::endl;
+  std::cout << "loop   " << refTime*nsPerCluster << " ns/cluster" << std::endl;
+  std::cout << "kernel " << time*nsPerCluster << " ns/cluster" << std::endl;
+  std::cout << "speedup " << (time > 0 ? refTime/time : 0) << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,153 @@
+///////////////////////////////////////////////
+// Check that MonoTrackMatcher matches toy
+// monopole tracks to the Ecal clusters where
+// they cross the barrel cylinder or the endcap
+// planes: each track has a cluster at its own
+// impact point, in shuffled order among others.
+// Endcap tracks include ones bent in RZ back to
+// the endcap opposite to their initial slope.
+// Also checks rVz against zVr on curved RZ
+// parabolas.
+//   monoTrackMatcherTest [nEvents] [nTracks]
+///////////////////////////////////////////////
+
+#include <vector>
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+
+#include "Monopoles/MonoAlgorithms/interface/MonoTrackMatcher.h"
+#include "Monopoles/MonoAlgorithms/interface/MonoTrackExtrapolator.h"
+#include "Monopoles/MonoAlgorithms/interface/MonoTrack.h"
+
+#include "DataFormats/CaloRecHit/interface/CaloCluster.h"
+
+
+double uniform(double lo, double hi) { return lo + (hi-lo)*(rand()+0.5)/(RAND_MAX+1.); }
+
+int shuffleIndex(int n) { return rand()%n; }
+
+// the toy track at radius r: z of the RZ parabola, phi of a track from
+// the origin bending with radius R
+void pointAt(const Mono::MonoTrack &track, double r, double &x, double &y, double &z)
+{
+  Mono::MonoTrackExtrapolator extrap;
+  const double phi = extrap.phiVr(track.xyp0(),track.xyp1(),track.xyp2(),r);
+  x = r*cos(phi);
+  y = r*sin(phi);
+  z = extrap.zVr(track.rzp0(),track.rzp1(),track.rzp2(),r);
+}
+
+
+int main(int argc, char **argv) {
+
+  const unsigned nEvents = argc > 1 ? atoi(argv[1]) : 1000;
+  const unsigned nTracks = argc > 2 ? atoi(argv[2]) : 4;
+
+  // the Ecal surfaces of the matcher, in cm
+  const double ecalRad = 129., eeZ = 314.4;
+
+  srand(4357);
+
+  Mono::MonoTrackExtrapolator extrap;
+
+  // rVz inverts zVr on its first crossing, either sign of z and curvature
+  for ( unsigned i=0; i != 10000; i++ ) {
+    const double p0 = uniform(-10.,10.), p1 = uniform(-5.,5.), p2 = uniform(-1e-3,1e-3);
+    const double r = uniform(1.,150.);
+    const double z = extrap.zVr(p0,p1,p2,r);
+    const double back = extrap.rVz(p0,p1,p2,z);
+    assert( back > 0. && back <= r*(1+1e-9) );
+    assert( std::fabs(extrap.zVr(p0,p1,p2,back) - z) < 1e-6*(1+std::fabs(z)) );
+  }
+  // straight lines, and lines that never get there
+  assert( std::fabs(extrap.rVz(0.,2.,0.,eeZ) - eeZ/2) < 1e-9 );
+  assert( extrap.rVz(0.,2.,0.,-eeZ) == -1 );
+  assert( extrap.rVz(0.,0.,0.,eeZ) == -1 );
+
+  // bent back from +z: reaches z = -314.4 at r ~ 111 cm, never +314.4
+  {
+    const Mono::MonoTrack bent(0.,0.3,1e4,0.,0.5,-0.03);
+    std::vector<Mono::MonoTrackMatcher::Impact> impacts;
+    Mono::MonoTrackMatcher::extrapolate(1,&bent,false,impacts);
+    const double r = extrap.rVz(0.,0.5,-0.03,-eeZ);
+    assert( extrap.rVz(0.,0.5,-0.03,eeZ) == -1 && r > 100. && r < 120. );
+    assert( impacts[0].valid && std::fabs(impacts[0].eta - extrap.eta(-eeZ,r)) < 1e-9 );
+  }
+
+  Mono::MonoTrackMatcher matcher(0.5);
+
+  unsigned nMatched[3] = {0, 0, 0}, nTried[3] = {0, 0, 0};
+  double maxDist = 0.;
+
+  for ( unsigned e=0; e != nEvents; e++ ) {
+    for ( unsigned part=0; part != 3; part++ ) {
+      const bool barrel = part == 0, bent = part == 2;
+
+      // tracks into the barrel or either endcap, slightly bent in RZ, or
+      // bent back to the other endcap at 60-125 cm
+      std::vector<Mono::MonoTrack> tracks;
+      std::vector<reco::CaloCluster> clusters;
+      for ( unsigned t=0; t != nTracks; t++ ) {
+        const double phi0 = uniform(-M_PI,M_PI);
+        double side, rzp1, rzp2;
+        if ( bent ) {
+          side = rand()%2 ? 1. : -1.;
+          rzp1 = -side*uniform(0.1,2.);
+          const double rEnd = uniform(60.,125.);
+          rzp2 = (side*eeZ - rzp1*rEnd)/(rEnd*rEnd);
+        } else {
+          const double eta = barrel ? uniform(-1.4,1.4) : (rand()%2 ? 1. : -1.)*uniform(1.7,2.8);
+          side = eta < 0 ? -1. : 1.;
+          rzp1 = sinh(eta);
+          rzp2 = uniform(-1e-5,1e-5);
+        }
+        const Mono::MonoTrack track(0.,phi0,uniform(1e3,1e5),bent ? 0. : uniform(-1.,1.),rzp1,rzp2);
+        tracks.push_back(track);
+
+        const double r = barrel ? ecalRad : extrap.rVz(track.rzp0(),track.rzp1(),track.rzp2(),side*eeZ);
+        assert( r > 0. && (barrel || r < ecalRad) );
+        double x, y, z;
+        pointAt(track,r,x,y,z);
+        clusters.push_back(reco::CaloCluster(100.,math::XYZPoint(x,y,z),reco::CaloID(barrel ? reco::CaloID::DET_ECAL_BARREL : reco::CaloID::DET_ECAL_ENDCAP)));
+      }
+
+      // clusters in another order than the tracks, with a few others
+      std::vector<unsigned> order(nTracks);
+      for ( unsigned t=0; t != nTracks; t++ ) order[t] = t;
+      std::random_shuffle(order.begin(),order.end(),shuffleIndex);
+      std::vector<const reco::CaloCluster *> pointers;
+      for ( unsigned t=0; t != nTracks; t++ ) pointers.push_back(&clusters[order[t]]);
+      std::vector<reco::CaloCluster> others;
+      for ( unsigned i=0; i != 3; i++ ) {
+        const double phi = uniform(-M_PI,M_PI);
+        others.push_back(reco::CaloCluster(20.,math::XYZPoint(ecalRad*cos(phi),ecalRad*sin(phi),uniform(-eeZ,eeZ)),reco::CaloID()));
+      }
+      for ( unsigned i=0; i != others.size(); i++ ) pointers.push_back(&others[i]);
+
+      std::vector<Mono::MonoTrackMatcher::Impact> impacts;
+      Mono::MonoTrackMatcher::extrapolate(nTracks,&tracks[0],barrel,impacts);
+      std::vector<int> matchMap;
+      std::vector<double> distances;
+      matcher.match(pointers.size(),&pointers[0],impacts,matchMap,distances);
+
+      for ( unsigned t=0; t != nTracks; t++ ) {
+        nTried[part]++;
+        assert( impacts[t].valid );
+        assert( matchMap[t] >= 0 && (unsigned)matchMap[t] < nTracks );
+        assert( order[matchMap[t]] == t );
+        assert( distances[t] < 1e-6 );
+        if ( distances[t] > maxDist ) maxDist = distances[t];
+        nMatched[part]++;
+      }
+    }
+  }
+
+  std::cout << nMatched[0] << " of " << nTried[0] << " barrel, " << nMatched[1] << " of " << nTried[1]
+            << " endcap and " << nMatched[2] << " of " << nTried[2] << " bent-back endcap tracks matched to their own cluster, max dR "
+            << maxDist << std::endl;
+
+  return 0;
+}
@@ -25,6 +25,8 @@
 #include "TH2D.h"
 #include "TFile.h"
 
+#include "Monopoles/MonoAlgorithms/interface/MonoTriggerMenu.h"
+
 using namespace std;
 
 //================================================
@@ -588,8 +590,8 @@ int main ( int argc, char **argv ) {
 
 
   // trigger branches
-  vector<bool> * trigResults = 0;
-  vector<string> * trigNames = 0; 
+  unsigned trigMenu = 0;
+  vector<ULong64_t> * trigBits = 0;
 
   unsigned nCandidates;
   vector<double> * subHits = 0;
@@ -615,8 +617,16 @@ int main ( int argc, char **argv ) {
   TFile inFile(inFileName.c_str());
   TTree *tree = (TTree*)inFile.Get("monopoles");
 
-  tree->SetBranchAddress("trigResult",&trigResults); 
-  tree->SetBranchAddress("trigNames",&trigNames);
+  tree->SetBranchAddress("trigMenu",&trigMenu);
+  tree->SetBranchAddress("trigBits",&trigBits);
+
+  // bits of the paths in trigNameList, for each menu:
+  // pathBits[menu*nTriggerNames+tn]
+  Mono::MonoTriggerMenu menus(inFile);
+  vector<vector<unsigned> > pathBits;
+  for ( unsigned m=0; m != menus.size(); m++ )
+    for ( unsigned tn=0; tn != nTriggerNames; tn++ )
+      pathBits.push_back( menus.find(m,trigNameList[tn]) );
 
   tree->SetBranchAddress("cand_N",&nCandidates);
   tree->SetBranchAddress("cand_dist",&dist);
@@ -689,20 +699,17 @@ int main ( int argc, char **argv ) {
     // do the analysis for no trigger selection
     noTriggerAnalysis.doAnalysis(true,candVec);
     
-    // loop over triggers check if name is in the list
-    const unsigned nTrigs = trigNames->size();
-    for ( unsigned tr=0; tr != nTrigs; tr++ ) {
-      const string & trName = (*trigNames)[tr];
-      for ( unsigned tn=0; tn != nTriggerNames; tn++ ) {
-	if ( trName.find(trigNameList[tn].c_str()) != string::npos ) {
-
-	  // a very verbose debug statement to print out (just in case)
-	  //cout << "trName " << trName << " " << trName.find(trigNameList[tn].c_str()) << " with result " << (*trigResults)[tr] << endl;	
-	  triggerAnalyses[tn].doAnalysis((*trigResults)[tr],candVec);
-
-	}
+    // loop over the paths of the list in this menu
+    for ( unsigned tn=0; tn != nTriggerNames; tn++ ) {
+      const vector<unsigned> & bits = pathBits[trigMenu*nTriggerNames+tn];
+      for ( unsigned b=0; b != bits.size(); b++ ) {
+	const bool accept = Mono::MonoTriggerMenu::accept(*trigBits,bits[b]);
+
+	// a very verbose debug statement to print out (just in case)
+	//cout << "trName " << menus.names(trigMenu)[bits[b]] << " with result " << accept << endl;
+	triggerAnalyses[tn].doAnalysis(accept,candVec);
       }
-    } 
+    }
   
 
   }
@@ -201,14 +201,13 @@ class MonoAnalysis : public edm::EDAnalyzer {
     std::vector<int>    m_clust_hsInSeed;
     std::vector<int>    m_clust_hsWeird;
     std::vector<int>    m_clust_hsDiWeird;
-    // Treat these arrays as 3D arrays
-    // There is space for 15 clusters of 100 total elements in each cluster
-    // One must use m_nClusters, m_clust_L, and m_clust_W when unpacking
-    // the cluster from the TTree.
-    static const unsigned WS = 100;
-    static const unsigned SS = 15*100;
-    double m_clust_Ecells[1500]; 
-    double m_clust_Tcells[1500]; 
+    // Cell energies and times of all clusters, one after the other:
+    // cluster i has cells [m_clust_cellBegin[i], m_clust_cellBegin[i+1]),
+    // cell (k,j) at m_clust_cellBegin[i]+j*m_clust_L[i]+k with k along
+    // the length and j across the width.
+    std::vector<unsigned> m_clust_cellBegin;
+    std::vector<float> m_clust_Ecells;
+    std::vector<float> m_clust_Tcells;
 
     // MC gen monopoles
     double m_mono_eta;
@@ -464,9 +463,10 @@ MonoAnalysis::analyze(const edm::Event& iEvent, const edm::EventSetup& iSetup)
     bool kDiWeird=false;
 
     // fill in cluster energy and time maps
-    const bool exceedsWS = length*width > WS;
-    const bool exceedsSS = length*width+i*WS > SS;
-    const bool excessive = exceedsWS || exceedsSS;
+    const unsigned cellBegin = m_clust_Ecells.size();
+    m_clust_Ecells.resize(cellBegin+length*width);
+    m_clust_Tcells.resize(cellBegin+length*width);
+    m_clust_cellBegin.push_back(cellBegin+length*width);
     for ( unsigned j=0; j != width; j++ ) {
       int ji = (int)j-(int)width/2;
       for ( unsigned k=0; k != length; k++ ) {
@@ -480,8 +480,8 @@ MonoAnalysis::analyze(const edm::Event& iEvent, const edm::EventSetup& iSetup)
 	}
 	hist->SetBinContent(k+1,j+1,energy);
 	Thist->SetBinContent(k+1,j+1,cluster.time(k,ji,ebMap));
-	if ( !excessive ) m_clust_Ecells[i*WS+j*length+k] = cluster.energy(k,ji,ebMap);
-	if ( !excessive ) m_clust_Tcells[i*WS+j*length+k] = cluster.time(k,ji,ebMap);
+	m_clust_Ecells[cellBegin+j*length+k] = energy;
+	m_clust_Tcells[cellBegin+j*length+k] = cluster.time(k,ji,ebMap);
       }
     }
 
@@ -803,8 +803,9 @@ MonoAnalysis::beginRun(edm::Run const&, edm::EventSetup const&)
   m_tree->Branch("clust_hsInSeed",&m_clust_hsInSeed);
   m_tree->Branch("clust_hsWeird",&m_clust_hsWeird);
   m_tree->Branch("clust_hsDiWeird",&m_clust_hsDiWeird);
-  m_tree->Branch("clust_Ecells",&m_clust_Ecells,"clust_Ecells[1500]/D");
-  m_tree->Branch("clust_Tcells",&m_clust_Tcells,"clust_Tcells[1500]/D");
+  m_tree->Branch("clust_cellBegin",&m_clust_cellBegin);
+  m_tree->Branch("clust_Ecells",&m_clust_Ecells);
+  m_tree->Branch("clust_Tcells",&m_clust_Tcells);
 
   m_tree->Branch("mono_eta",&m_mono_eta,"mono_eta/D");
   m_tree->Branch("mono_phi",&m_mono_phi,"mono_phi/D");
@@ -922,10 +923,9 @@ void MonoAnalysis::clear()
     m_clust_hsInSeed.clear();
     m_clust_hsWeird.clear();
     m_clust_hsDiWeird.clear();
-    for ( unsigned i=0; i != SS; i++ ){
-      m_clust_Ecells[i] = -999.;
-      m_clust_Tcells[i] = -999.;
-    }
+    m_clust_cellBegin.assign(1,0);
+    m_clust_Ecells.clear();
+    m_clust_Tcells.clear();
 
     m_mono_eta = 0.;
     m_mono_phi = 0.;
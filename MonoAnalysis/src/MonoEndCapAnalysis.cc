@@ -65,6 +65,7 @@
 
 // Monopole algorithms includes
 #include "Monopoles/MonoAlgorithms/interface/MonoEcalObs0.h"
+#include "Monopoles/MonoAlgorithms/interface/MonoEcalGeomTable.h"
 
 // ROOT includes
 #include "TTree.h"
@@ -128,14 +129,6 @@ class MonoEndCapAnalysis : public edm::EDAnalyzer {
     edm::InputTag m_TagEcalEE_RecHits;
     bool m_isData;
 
-    /////////////////////////////
-    // map between detId,x,y,eta,phi
-    struct EEDetIdMap {
-	EEDetId id;
-	double x,y,eta,phi;
-    };
-    std::vector<EEDetIdMap> m_idMap;
-
 
     // TFileService
     edm::Service<TFileService> m_fs;
@@ -325,14 +318,15 @@ MonoEndCapAnalysis::analyze(const edm::Event& iEvent, const edm::EventSetup& iSe
   const CaloSubdetectorGeometry *geom = m_caloGeo->getSubdetectorGeometry(DetId::Ecal,EcalEndcap);
 
   // fill RecHit branches
+  const Mono::MonoEcalGeomTable::Cells & eeCells = Mono::MonoEcalGeomTable::shared(iSetup).ee();
   EERecHitCollection::const_iterator itHit = ecalRecHits->begin();
   for ( ; itHit != ecalRecHits->end(); itHit++ ) {
 
     EEDetId detId( (*itHit).id() );
-    const CaloCellGeometry *cell = geom->getGeometry( detId );
+    const unsigned idx = detId.hashedIndex();
 
-    m_ehit_eta.push_back( cell->getPosition().eta() );
-    m_ehit_phi.push_back( cell->getPosition().phi() );
+    m_ehit_eta.push_back( eeCells.eta[idx] );
+    m_ehit_phi.push_back( eeCells.phi[idx] );
     m_ehit_energy.push_back( (*itHit).energy() );
     m_ehit_time.push_back( (*itHit).time() );
     m_ehit_otEnergy.push_back( (*itHit).outOfTimeEnergy() );
@@ -340,9 +334,9 @@ MonoEndCapAnalysis::analyze(const edm::Event& iEvent, const edm::EventSetup& iSe
     m_ehit_kWeird.push_back( (*itHit).checkFlag(EcalRecHit::kWeird) );
     m_ehit_kDiWeird.push_back( (*itHit).checkFlag(EcalRecHit::kDiWeird) );
 
-    m_ehit_x.push_back( cell->getPosition().x() );
-    m_ehit_y.push_back( cell->getPosition().y() );
-    m_ehit_z.push_back( cell->getPosition().z() );
+    m_ehit_x.push_back( eeCells.x[idx] );
+    m_ehit_y.push_back( eeCells.y[idx] );
+    m_ehit_z.push_back( eeCells.z[idx] );
 
     /*if (detId.zside() > 0 ) {
       int bin = hEmapp->FindBin(detId.ix(),detId.iy());
@@ -542,18 +536,6 @@ MonoEndCapAnalysis::beginRun(edm::Run const& run, edm::EventSetup const& es)
     hix->Fill(eeId.ix());
     hiy->Fill(eeId.iy());
     hi->Fill(eeId.ix(),eeId.iy());
-
-    const CaloCellGeometry *cell = geom->getGeometry( eeId );
-    const GlobalPoint & pos = cell->getPosition();
-    
-    EEDetIdMap map;
-    map.id = eeId;
-    map.x = pos.x();
-    map.y = pos.y();
-    map.eta = pos.eta();
-    map.phi = pos.phi();
-
-    m_idMap.push_back(map);
   }
   
 
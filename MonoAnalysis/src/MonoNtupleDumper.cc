@@ -21,6 +21,8 @@
 // system include files
 #include <memory>
 #include <algorithm>
+#include <sstream>
+#include <cmath>
 
 // user include files
 #include "FWCore/Framework/interface/Frameworkfwd.h"
@@ -31,10 +33,13 @@
 #include "FWCore/Framework/interface/MakerMacros.h"
 
 #include "FWCore/ParameterSet/interface/ParameterSet.h"
+#include "FWCore/MessageLogger/interface/MessageLogger.h"
+#include "FWCore/Utilities/interface/Exception.h"
 #include "FWCore/ServiceRegistry/interface/Service.h"
 #include "CommonTools/UtilAlgos/interface/TFileService.h"
 
 #include "DataFormats/Math/interface/deltaR.h"
+#include "DataFormats/Math/interface/deltaPhi.h"
 
 // data formats
 #include "DataFormats/EcalRecHit/interface/EcalRecHit.h"
@@ -76,6 +81,12 @@
 #include "Monopoles/MonoAlgorithms/interface/ClustCategorizer.h"
 #include "Monopoles/MonoAlgorithms/interface/MonoTrackMatcher.h"
 #include "Monopoles/MonoAlgorithms/interface/MonoGenTrackExtrapolator.h"
+#include "Monopoles/MonoAlgorithms/interface/MonoTriggerMenu.h"
+#include "Monopoles/MonoAlgorithms/interface/MonoEcalGeomTable.h"
+#include "Monopoles/MonoAlgorithms/interface/MonoEcalShapeCache.h"
+#include "Monopoles/MonoAlgorithms/interface/MonoHcalIsoGrid.h"
+#include "Monopoles/MonoAlgorithms/interface/MonoAsyncTreeWriter.h"
+#include "Monopoles/MonoAlgorithms/interface/MonoDeDxSignificance.h"
 
 #include "Monopoles/TrackCombiner/interface/MplTracker.h"
 
@@ -86,6 +97,7 @@
 #include "TH1D.h"
 #include "TF2.h"
 #include "TMath.h"
+#include "TStopwatch.h"
 
 
 //
@@ -122,8 +134,25 @@ class MonoNtupleDumper : public edm::EDAnalyzer {
     // clear tree variables
     void clear();
 
+    // monopole candidates from the track matches of MplTracker::doMatch
     void rematch(); 
 
+    // look up or record the menu of the event's trigger names
+    void setTriggerMenu(const edm::TriggerNames &);
+
+    // HCAL isolation of a cluster in the configured mode
+    double hcalIso(const reco::CaloCluster &, const EgammaHcalIsolation &);
+
+    // dE/dx significance of a track from its saturated subhits
+    inline double dEdXSig(const MplTrackRecord &set) const { return m_dEdXSig(set.SubHits,set.SatSubHits); }
+
+    // the loose preselection of the filter mode, after tracking
+    // and the RecHits of the shape cache
+    bool preselect(const edm::Event &);
+
+    // the EB RecHit branches, after rematch() for the ROI centres
+    void fillRecHits(const EBRecHitCollection &, const edm::EventSetup &);
+
       // ----------member data ---------------------------
 
     std::string m_output;
@@ -146,6 +175,28 @@ class MonoNtupleDumper : public edm::EDAnalyzer {
     // Monopole Ecal Observables
     Mono::MonoEcalObs0 m_ecalObs;
 
+    // 5x5 shapes of the basic clusters, and the time spent on the clusters
+    Mono::MonoEcalShapeCache m_shapes;
+    TStopwatch m_clusterWatch;
+    unsigned m_nClusterEvents;
+
+    // HCAL isolation: from the eta-phi grid, EgammaHcalIsolation
+    // ("exact"), or the exact one with the differences to the grid
+    // reported at endJob ("check")
+    enum HcalIsoMode { kHcalIsoGrid=0, kHcalIsoExact, kHcalIsoCheck };
+    HcalIsoMode m_hcalIsoMode;
+    Mono::MonoHcalIsoGrid m_hcalGrid;
+    unsigned m_hcalIsoChecks;
+    double m_hcalIsoSumDiff, m_hcalIsoMaxDiff;
+
+    // EB RecHits: all of them ("all"), or ("roi") only those within
+    // the eta-phi windows around the candidates and the EB clusters
+    // above m_roiClusterE, with the energy of the others summed per
+    // trigger tower; the settings go to the recHitROI tree
+    bool m_roiOutput;
+    double m_roiEtaHalfWidth, m_roiPhiHalfWidth, m_roiClusterE;
+    std::vector<float> m_towerSum;
+
     //Tracker
     MplTracker *_Tracker;
 
@@ -164,8 +215,38 @@ class MonoNtupleDumper : public edm::EDAnalyzer {
 
     TTree * m_tree;
 
+    // fills m_tree, synchronously unless WriterQueueDepth is set
+    Mono::MonoAsyncTreeWriter m_writer;
+
+    // dE/dx significance table for the strip saturation probability
+    // DeDxSigProbability, made at beginJob
+    double m_dEdXProb;
+    unsigned m_dEdXTableHits;
+    Mono::MonoDeDxSignificance m_dEdXSig;
+
+    // filter mode: only events with a track of dE/dx significance
+    // above m_preselDeDxSig or a combined cluster with frac51 above
+    // m_preselFrac51 are analysed and written; m_countTree counts
+    // the processed and accepted events of each run
+    bool m_filter;
+    double m_preselDeDxSig, m_preselFrac51;
+    TTree * m_countTree;
+    unsigned m_countRun, m_runProcessed, m_runAccepted;
+
     bool _ClustHitOutput, _EleJetPhoOutput;
 
+    // the EB and EE cluster collections candidates are made of
+    // ("combined", "clean" or "unclean"), and their branches
+    struct CandidateClusters {
+      EcalClustID id;
+      const std::vector<double> *eta, *phi, *frac51, *frac15, *e55, *hcalIso;
+    };
+    CandidateClusters m_candEB, m_candEE;
+
+    // the basic cluster collection of each EcalClustID, read by the
+    // cluster loops and the preselection
+    edm::InputTag m_clustTags[fNEcalClustID];
+
     // Event information
     unsigned m_run;
     unsigned m_lumi;
@@ -173,10 +254,20 @@ class MonoNtupleDumper : public edm::EDAnalyzer {
 
     unsigned m_NPV;
 
-    bool m_isFirstEvent;
+    // HLT menus, one entry each in m_menuTree when first seen,
+    // keyed by the table name (or the parameter set id of the
+    // trigger names if they are not the HLTConfigProvider's);
+    // the event only keeps the menu id and the accept bits
+    TTree * m_menuTree;
+    std::map<std::string,unsigned> m_menuIds;
+    unsigned m_menuRun;
+    std::string m_menuTable;
+    std::vector<std::string> m_menuNames;
+
+    edm::ParameterSetID m_trigPSetID;
     unsigned m_NTrigs;
-    std::vector<bool> m_trigResults;
-    std::vector<std::string> m_trigNames;
+    unsigned m_trigMenu;
+    std::vector<ULong64_t> m_trigBits;
 
     // Ecal Observable information
     unsigned m_nClusters;
@@ -207,14 +298,13 @@ class MonoNtupleDumper : public edm::EDAnalyzer {
     std::vector<int>    m_clust_hsInSeed;
     std::vector<int>    m_clust_hsWeird;
     std::vector<int>    m_clust_hsDiWeird;
-    // Treat these arrays as 3D arrays
-    // There is space for 15 clusters of 100 total elements in each cluster
-    // One must use m_nClusters, m_clust_L, and m_clust_W when unpacking
-    // the cluster from the TTree.
-    static const unsigned WS = 100;
-    static const unsigned SS = 15*100;
-    double m_clust_Ecells[1500]; 
-    double m_clust_Tcells[1500]; 
+    // Cell energies and times of all clusters, one after the other:
+    // cluster i has cells [m_clust_cellBegin[i], m_clust_cellBegin[i+1]),
+    // cell (k,j) at m_clust_cellBegin[i]+j*m_clust_L[i]+k with k along
+    // the length and j across the width.
+    std::vector<unsigned> m_clust_cellBegin;
+    std::vector<float> m_clust_Ecells;
+    std::vector<float> m_clust_Tcells;
 
 
 
@@ -323,6 +413,15 @@ class MonoNtupleDumper : public edm::EDAnalyzer {
     std::vector<double> m_ehit_kWeird;
     std::vector<double> m_ehit_kDiWeird;
 
+    // ROI mode: the windows (type 0 candidate, 1 cluster), and the
+    // towers with energy outside them, index (ieta tower from 0)*72
+    // + iphi tower from 0
+    std::vector<float> m_roi_eta;
+    std::vector<float> m_roi_phi;
+    std::vector<int> m_roi_type;
+    std::vector<unsigned> m_tower_idx;
+    std::vector<float> m_tower_E;
+
 
     // Jet information
     unsigned m_jet_N;
@@ -464,11 +563,75 @@ MonoNtupleDumper::MonoNtupleDumper(const edm::ParameterSet& iConfig)
   ,m_Tag_MET(iConfig.getParameter<edm::InputTag>("METTag") )
   ,m_isData(iConfig.getParameter<bool>("isData") )
   ,m_ecalObs(iConfig)
+  ,m_shapes(iConfig.getUntrackedParameter<bool>("ClusterShapeCache", true))
+  ,m_nClusterEvents(0)
+  ,m_hcalIsoChecks(0)
+  ,m_hcalIsoSumDiff(0.)
+  ,m_hcalIsoMaxDiff(0.)
+  ,m_roiEtaHalfWidth(iConfig.getUntrackedParameter<double>("ROIEtaHalfWidth", 0.3))
+  ,m_roiPhiHalfWidth(iConfig.getUntrackedParameter<double>("ROIPhiHalfWidth", 0.3))
+  ,m_roiClusterE(iConfig.getUntrackedParameter<double>("ROIClusterEnergy", 50.))
+  ,m_writer(iConfig.getUntrackedParameter<unsigned>("WriterQueueDepth", 0))
+  ,m_dEdXProb(iConfig.getUntrackedParameter<double>("DeDxSigProbability", 0.07))
+  ,m_dEdXTableHits(iConfig.getUntrackedParameter<unsigned>("DeDxSigTableHits", 1024))
+  ,m_dEdXSig(m_dEdXProb,0)
+  ,m_filter(iConfig.getUntrackedParameter<bool>("FilterMode", false))
+  ,m_preselDeDxSig(iConfig.getUntrackedParameter<double>("PreselDeDxSig", 3.))
+  ,m_preselFrac51(iConfig.getUntrackedParameter<double>("PreselFrac51", 0.6))
+  ,m_countTree(0)
+  ,m_countRun(0)
+  ,m_runProcessed(0)
+  ,m_runAccepted(0)
 {
+  m_clusterWatch.Reset();
+
+  const std::string hcalIsoMode = iConfig.getUntrackedParameter<std::string>("HcalIsoMode", "grid");
+  if ( hcalIsoMode == "grid" ) m_hcalIsoMode = kHcalIsoGrid;
+  else if ( hcalIsoMode == "exact" ) m_hcalIsoMode = kHcalIsoExact;
+  else if ( hcalIsoMode == "check" ) m_hcalIsoMode = kHcalIsoCheck;
+  else throw cms::Exception("Configuration") << "Unknown HcalIsoMode " << hcalIsoMode << ", use grid, exact or check";
 
-  m_isFirstEvent = true;
+  const std::string recHitOutput = iConfig.getUntrackedParameter<std::string>("RecHitOutput", "all");
+  if ( recHitOutput == "all" ) m_roiOutput = false;
+  else if ( recHitOutput == "roi" ) m_roiOutput = true;
+  else throw cms::Exception("Configuration") << "Unknown RecHitOutput " << recHitOutput << ", use all or roi";
+  if ( m_roiOutput ) m_towerSum.assign(34*72,0.f);
+
+  m_NTrigs = 0;
+  m_trigMenu = 0;
 
   _Tracker = new MplTracker(iConfig);
+  m_clustTags[fEBClean] = iConfig.getUntrackedParameter<edm::InputTag>("EBCleanClusters"
+    ,edm::InputTag("hybridSuperClusters","hybridBarrelBasicClusters"));
+  m_clustTags[fEBUnclean] = iConfig.getUntrackedParameter<edm::InputTag>("EBUncleanClusters"
+    ,edm::InputTag("hybridSuperClusters","uncleanOnlyHybridBarrelBasicClusters"));
+  m_clustTags[fEBCombined] = iConfig.getUntrackedParameter<edm::InputTag>("EBCombinedClusters"
+    ,edm::InputTag("uncleanSCRecovered","uncleanHybridBarrelBasicClusters"));
+  m_clustTags[fEEClean] = iConfig.getUntrackedParameter<edm::InputTag>("EECleanClusters"
+    ,edm::InputTag("multi5x5SuperClusters","multi5x5EndcapBasicClusters"));
+  m_clustTags[fEEUnclean] = iConfig.getUntrackedParameter<edm::InputTag>("EEUncleanClusters"
+    ,edm::InputTag("multi5x5SuperClusters","uncleanOnlyMulti5x5EndcapBasicClusters"));
+  m_clustTags[fEECombined] = iConfig.getUntrackedParameter<edm::InputTag>("EECombinedClusters"
+    ,edm::InputTag("uncleanEERecovered","uncleanEndcapBasicClusters"));
+
+  const std::string candClusters = iConfig.getUntrackedParameter<std::string>("CandidateClusters", "combined");
+  if ( candClusters == "combined" ) {
+    const CandidateClusters eb = { fEBCombined, &m_egComb_eta, &m_egComb_phi, &m_egComb_frac51, &m_egComb_frac15, &m_egComb_e55, &m_egComb_hcalIso };
+    const CandidateClusters ee = { fEECombined, &m_eeComb_eta, &m_eeComb_phi, &m_eeComb_frac51, &m_eeComb_frac15, &m_eeComb_e55, &m_eeComb_hcalIso };
+    m_candEB = eb;
+    m_candEE = ee;
+  } else if ( candClusters == "clean" ) {
+    const CandidateClusters eb = { fEBClean, &m_egClean_eta, &m_egClean_phi, &m_egClean_frac51, &m_egClean_frac15, &m_egClean_e55, &m_egClean_hcalIso };
+    const CandidateClusters ee = { fEEClean, &m_eeClean_eta, &m_eeClean_phi, &m_eeClean_frac51, &m_eeClean_frac15, &m_eeClean_e55, &m_eeClean_hcalIso };
+    m_candEB = eb;
+    m_candEE = ee;
+  } else if ( candClusters == "unclean" ) {
+    const CandidateClusters eb = { fEBUnclean, &m_egClust_eta, &m_egClust_phi, &m_egClust_frac51, &m_egClust_frac15, &m_egClust_e55, &m_egClust_hcalIso };
+    const CandidateClusters ee = { fEEUnclean, &m_eeUnclean_eta, &m_eeUnclean_phi, &m_eeUnclean_frac51, &m_eeUnclean_frac15, &m_eeUnclean_e55, &m_eeUnclean_hcalIso };
+    m_candEB = eb;
+    m_candEE = ee;
+  } else throw cms::Exception("Configuration") << "Unknown CandidateClusters " << candClusters << ", use combined, clean or unclean";
+
   _ClustHitOutput = iConfig.getUntrackedParameter<bool>("ClustHitOutput", true);
   _EleJetPhoOutput = iConfig.getUntrackedParameter<bool>("EleJetPhoOutput", true);
 }
@@ -503,37 +666,52 @@ MonoNtupleDumper::analyze(const edm::Event& iEvent, const edm::EventSetup& iSetu
   Handle<TriggerResults> HLTR;
   iEvent.getByLabel(m_hltResults,HLTR);
 
-  // get a list of trigger names
-  //std::vector<std::string> hltNames = m_hltConfig.triggerNames();
-  edm::TriggerNames hltNames(iEvent.triggerNames(*HLTR));
-  const std::vector<std::string> & hltNameVec = hltNames.triggerNames();
-
-  // fill trigger names and set the size of the trigger result vector
-  if ( m_isFirstEvent ) {
-    m_isFirstEvent=false;
-    m_NTrigs = HLTR->size();
-    m_trigResults.resize(m_NTrigs);
-    m_trigNames.resize(m_NTrigs);
-
-    for ( unsigned i=0; i != m_NTrigs; i++ )
-      m_trigNames[i] = hltNameVec[i];
-  } 
-  // check order of trigger names does not change
-  // uncomment to run check.  Otherwise, it will take up time.
-  /*else {
-    for ( unsigned i=9; i != m_NTrigs; i++ ) {
-      assert(m_trigNames[i].compare(hltNameVec[i])); 
-    }
-  }*/
-  
-  // cycle over trigger names
-  const unsigned nNames = HLTR->size();
-  for ( unsigned i=0; i != nNames; i++ ) {
-    m_trigResults[i] = HLTR->accept(i);
+  // the names only change with the menu, then the parameter set id does too
+  const edm::TriggerNames & hltNames = iEvent.triggerNames(*HLTR);
+  if ( hltNames.parameterSetID() != m_trigPSetID ) setTriggerMenu(hltNames);
 
-    // a very verbose debug statement!!
-    //cout << m_trigNames[i] << " " << HLTR->accept(i) << endl;
-  }
+  // pack the accept bits, path i is bit i%64 of word i/64
+  m_trigBits.assign(Mono::MonoTriggerMenu::words(m_NTrigs),0);
+  for ( unsigned i=0; i != m_NTrigs; i++ )
+    if ( HLTR->accept(i) ) Mono::MonoTriggerMenu::set(m_trigBits,i);
+
+  m_runProcessed++;
+
+
+  ////////////////////////////////
+  // Tracking analysis, first as the preselection needs its dE/dx
+  _Tracker->analyze(iEvent, iSetup);
+
+
+  // get RecHit collection
+  Handle<EBRecHitCollection > ecalRecHits;
+  iEvent.getByLabel(m_TagEcalEB_RecHits,ecalRecHits);
+  assert( ecalRecHits->size() > 0 );
+
+  // get EE RecHit collection
+  Handle<EERecHitCollection > eeRecHits;
+  iEvent.getByLabel(m_TagEcalEE_RecHits,eeRecHits);
+  assert( eeRecHits->size() > 0 );
+
+  // get HB RecHit Collection
+  Handle<HBHERecHitCollection> hbRecHits;
+  iEvent.getByLabel(m_TagHcalHBHE_RecHits,hbRecHits);
+  assert( hbRecHits->size() > 0 );
+
+
+  // get calo geometry and topology
+  ESHandle<CaloGeometry> calo;
+  iSetup.get<CaloGeometryRecord>().get(calo);
+
+  ESHandle<CaloTopology> topo;
+  iSetup.get<CaloTopologyRecord>().get(topo);
+  const CaloTopology * topology = (const CaloTopology*)topo.product();
+
+  m_shapes.newEvent(ecalRecHits.product(),eeRecHits.product(),topology);
+
+  // filter mode: nothing else is done for events failing the preselection
+  if ( m_filter && !preselect(iEvent) ) return;
+  m_runAccepted++;
 
 
   /////////////////////////////////////
@@ -609,9 +787,10 @@ MonoNtupleDumper::analyze(const edm::Event& iEvent, const edm::EventSetup& iSetu
     bool kDiWeird=false;
 
     // fill in cluster energy and time maps
-    const bool exceedsWS = length*width > WS;
-    const bool exceedsSS = length*width+i*WS > SS;
-    const bool excessive = exceedsWS || exceedsSS;
+    const unsigned cellBegin = m_clust_Ecells.size();
+    m_clust_Ecells.resize(cellBegin+length*width);
+    m_clust_Tcells.resize(cellBegin+length*width);
+    m_clust_cellBegin.push_back(cellBegin+length*width);
     for ( unsigned j=0; j != width; j++ ) {
       int ji = (int)j-(int)width/2;
       for ( unsigned k=0; k != length; k++ ) {
@@ -625,8 +804,8 @@ MonoNtupleDumper::analyze(const edm::Event& iEvent, const edm::EventSetup& iSetu
 	}
 	hist.SetBinContent(k+1,j+1,energy);
 	Thist.SetBinContent(k+1,j+1,cluster.time(k,ji,ebMap));
-	if ( !excessive ) m_clust_Ecells[i*WS+j*length+k] = cluster.energy(k,ji,ebMap);
-	if ( !excessive ) m_clust_Tcells[i*WS+j*length+k] = cluster.time(k,ji,ebMap);
+	m_clust_Ecells[cellBegin+j*length+k] = energy;
+	m_clust_Tcells[cellBegin+j*length+k] = cluster.time(k,ji,ebMap);
       }
     }
 
@@ -691,70 +870,22 @@ MonoNtupleDumper::analyze(const edm::Event& iEvent, const edm::EventSetup& iSetu
   } */
 
 
-
-
-
-  // get RecHit collection
-  Handle<EBRecHitCollection > ecalRecHits;
-  iEvent.getByLabel(m_TagEcalEB_RecHits,ecalRecHits);
-  assert( ecalRecHits->size() > 0 );
-
-  // get EE RecHit collection
-  Handle<EERecHitCollection > eeRecHits;
-  iEvent.getByLabel(m_TagEcalEE_RecHits,eeRecHits);
-  assert( eeRecHits->size() > 0 );
-
-  // get HB RecHit Collection
-  Handle<HBHERecHitCollection> hbRecHits;
-  iEvent.getByLabel(m_TagHcalHBHE_RecHits,hbRecHits);
-  assert( hbRecHits->size() > 0 );
-
-
-  // get calo geometry and topology
-  ESHandle<CaloGeometry> calo;
-  iSetup.get<CaloGeometryRecord>().get(calo);
-  const CaloGeometry *m_caloGeo = (const CaloGeometry*)calo.product();
-  const CaloSubdetectorGeometry *geom = m_caloGeo->getSubdetectorGeometry(DetId::Ecal,EcalBarrel);
-
-  ESHandle<CaloTopology> topo;
-  iSetup.get<CaloTopologyRecord>().get(topo);
-  const CaloTopology * topology = (const CaloTopology*)topo.product();
-
   // get HE geometry and topology
   // get HB geometry and topology
   HBHERecHitMetaCollection mhbrh(hbRecHits.product());
   EgammaHcalIsolation egIso(0.4,0.1,10.,10.,10.,10.,calo,&mhbrh);
+  if ( m_hcalIsoMode != kHcalIsoExact ) m_hcalGrid.fill(*hbRecHits,*calo,10.,10.,10.,10.);
 
-  // fill RecHit branches
-  EBRecHitCollection::const_iterator itHit = ecalRecHits->begin();
-  for ( ; itHit != ecalRecHits->end(); itHit++ ) {
-
-    EBDetId detId( (*itHit).id() );
-    const CaloCellGeometry *cell = geom->getGeometry( detId );
-
-    m_ehit_eta.push_back( cell->getPosition().eta() );
-    m_ehit_phi.push_back( cell->getPosition().phi() );
-    m_ehit_energy.push_back( (*itHit).energy() );
-    m_ehit_time.push_back( (*itHit).time() );
-    m_ehit_otEnergy.push_back( (*itHit).outOfTimeEnergy() );
-
-    m_ehit_kWeird.push_back( (*itHit).checkFlag(EcalRecHit::kWeird) );
-    m_ehit_kDiWeird.push_back( (*itHit).checkFlag(EcalRecHit::kDiWeird) );
-    m_ehit_flag.push_back( (*itHit).recoFlag() );
-
-  }
 
+  // the six cluster collections
+  m_clusterWatch.Start(kFALSE);
+  m_nClusterEvents++;
 
   // get BasicCluster Collection
   Handle<BasicClusterCollection> bClusters;
-  edm::InputTag bcClusterTag("hybridSuperClusters","uncleanOnlyHybridBarrelBasicClusters"); 
-  iEvent.getByLabel(bcClusterTag,bClusters);
+  iEvent.getByLabel(m_clustTags[fEBUnclean],bClusters);
   const unsigned nbClusters = bClusters->size();
 
-  EcalClusterTools ecalTool;
-  std::vector<int> exclFlags;
-  std::vector<int> sevExcl;
-
   std::vector<const reco::CaloCluster *> ebUncleanClusters;
 
   tagger.clearTags();
@@ -772,15 +903,16 @@ MonoNtupleDumper::analyze(const edm::Event& iEvent, const edm::EventSetup& iSetu
     m_egClust_eta.push_back( (*bClusters)[i].eta() );
     m_egClust_phi.push_back( (*bClusters)[i].phi() );
 
-    const float e55 = ecalTool.e5x5((*bClusters)[i],ecalRecHits.product(),topology);
-    const float e51 = ecalTool.e5x1((*bClusters)[i],ecalRecHits.product(),topology);
-    const float e15 = ecalTool.e1x5((*bClusters)[i],ecalRecHits.product(),topology);
-    const float eMax = ecalTool.eMax((*bClusters)[i],ecalRecHits.product());
+    const Mono::MonoEcalShapeCache::Shape shape = m_shapes.shape((*bClusters)[i]);
+    const float e55 = shape.e55;
+    const float e51 = shape.e51;
+    const float e15 = shape.e15;
+    const float eMax = shape.eMax;
     m_egClust_frac51.push_back( e51/e55 );
     m_egClust_frac15.push_back( e15/e55 );
     m_egClust_e55.push_back(e55);
     m_egClust_eMax.push_back(eMax/e55);
-    m_egClust_hcalIso.push_back( egIso.getHcalESum((*bClusters)[i].position()) );
+    m_egClust_hcalIso.push_back( hcalIso((*bClusters)[i],egIso) );
 
     if ( !m_isData ) {
       m_egClust_matchDR.push_back(tagger.matchDR()[i]);
@@ -792,8 +924,7 @@ MonoNtupleDumper::analyze(const edm::Event& iEvent, const edm::EventSetup& iSetu
 
   // get BasicCluster Collection (cleaned)
   Handle<BasicClusterCollection> cClusters;
-  edm::InputTag ccClusterTag("hybridSuperClusters","hybridBarrelBasicClusters"); 
-  iEvent.getByLabel(ccClusterTag,cClusters);
+  iEvent.getByLabel(m_clustTags[fEBClean],cClusters);
   const unsigned ncClusters = cClusters->size();
 
   std::vector<const reco::CaloCluster *> ebCleanClusters;
@@ -813,15 +944,16 @@ MonoNtupleDumper::analyze(const edm::Event& iEvent, const edm::EventSetup& iSetu
     m_egClean_eta.push_back( (*cClusters)[i].eta() );
     m_egClean_phi.push_back( (*cClusters)[i].phi() );
 
-    const float e55 = ecalTool.e5x5((*cClusters)[i],ecalRecHits.product(),topology);
-    const float e51 = ecalTool.e5x1((*cClusters)[i],ecalRecHits.product(),topology);
-    const float e15 = ecalTool.e1x5((*cClusters)[i],ecalRecHits.product(),topology);
-    const float eMax = ecalTool.eMax((*cClusters)[i],ecalRecHits.product());
+    const Mono::MonoEcalShapeCache::Shape shape = m_shapes.shape((*cClusters)[i]);
+    const float e55 = shape.e55;
+    const float e51 = shape.e51;
+    const float e15 = shape.e15;
+    const float eMax = shape.eMax;
     m_egClean_frac51.push_back( e51/e55 );
     m_egClean_frac15.push_back( e15/e55 );
     m_egClean_e55.push_back(e55);
     m_egClean_eMax.push_back(eMax/e55);
-    m_egClean_hcalIso.push_back( egIso.getHcalESum((*cClusters)[i].position()) );
+    m_egClean_hcalIso.push_back( hcalIso((*cClusters)[i],egIso) );
 
     if ( !m_isData ) {
       m_egClean_matchDR.push_back(tagger.matchDR()[i]);
@@ -833,8 +965,7 @@ MonoNtupleDumper::analyze(const edm::Event& iEvent, const edm::EventSetup& iSetu
 
   // get BasicCluster Collection (combined)
   Handle<reco::BasicClusterCollection> combClusters;
-  edm::InputTag combClusterTag("uncleanSCRecovered","uncleanHybridBarrelBasicClusters"); 
-  iEvent.getByLabel(combClusterTag,combClusters);
+  iEvent.getByLabel(m_clustTags[fEBCombined],combClusters);
   const unsigned ncombClusters = combClusters->size();
 
   std::vector<const reco::CaloCluster *> ebClusters;
@@ -854,17 +985,18 @@ MonoNtupleDumper::analyze(const edm::Event& iEvent, const edm::EventSetup& iSetu
     m_egComb_eta.push_back( (*combClusters)[i].eta() );
     m_egComb_phi.push_back( (*combClusters)[i].phi() );
 
-    const float e55 = ecalTool.e5x5((*combClusters)[i],ecalRecHits.product(),topology);
-    const float e51 = ecalTool.e5x1((*combClusters)[i],ecalRecHits.product(),topology);
-    const float e15 = ecalTool.e1x5((*combClusters)[i],ecalRecHits.product(),topology);
-    const float eMax = ecalTool.eMax((*combClusters)[i],ecalRecHits.product());
+    const Mono::MonoEcalShapeCache::Shape shape = m_shapes.shape((*combClusters)[i],true);
+    const float e55 = shape.e55;
+    const float e51 = shape.e51;
+    const float e15 = shape.e15;
+    const float eMax = shape.eMax;
     m_egComb_frac51.push_back( e51/e55 );
     m_egComb_frac15.push_back( e15/e55 );
     m_egComb_e55.push_back(e55);
     m_egComb_eMax.push_back(eMax/e55);
-    m_egComb_e25Right.push_back(ecalTool.e2x5Right((*combClusters)[i],ecalRecHits.product(),topology));
-    m_egComb_e25Left.push_back(ecalTool.e2x5Left((*combClusters)[i],ecalRecHits.product(),topology));
-    m_egComb_hcalIso.push_back( egIso.getHcalESum((*combClusters)[i].position()) );
+    m_egComb_e25Right.push_back(shape.e25Right);
+    m_egComb_e25Left.push_back(shape.e25Left);
+    m_egComb_hcalIso.push_back( hcalIso((*combClusters)[i],egIso) );
 
     if ( !m_isData ) {
       m_egComb_matchDR.push_back(tagger.matchDR()[i]);
@@ -878,8 +1010,7 @@ MonoNtupleDumper::analyze(const edm::Event& iEvent, const edm::EventSetup& iSetu
   // ------------- EE clusters ----------------------
   // get basic clusters
   Handle<BasicClusterCollection> eeClean;
-  edm::InputTag eeCleanTag("multi5x5SuperClusters","multi5x5EndcapBasicClusters"); 
-  iEvent.getByLabel(eeCleanTag,eeClean);
+  iEvent.getByLabel(m_clustTags[fEEClean],eeClean);
   const unsigned nEECleanClusters = eeClean->size();
 
   std::vector<const reco::CaloCluster *> eeCleanClusters;
@@ -900,15 +1031,16 @@ MonoNtupleDumper::analyze(const edm::Event& iEvent, const edm::EventSetup& iSetu
     m_eeClean_eta.push_back( (*eeClean)[i].eta() );
     m_eeClean_phi.push_back( (*eeClean)[i].phi() );
 
-    const float e55 = ecalTool.e5x5((*eeClean)[i],eeRecHits.product(),topology);
-    const float e51 = ecalTool.e5x1((*eeClean)[i],eeRecHits.product(),topology);
-    const float e15 = ecalTool.e1x5((*eeClean)[i],eeRecHits.product(),topology);
-    const float eMax = ecalTool.eMax((*eeClean)[i],eeRecHits.product());
+    const Mono::MonoEcalShapeCache::Shape shape = m_shapes.shape((*eeClean)[i]);
+    const float e55 = shape.e55;
+    const float e51 = shape.e51;
+    const float e15 = shape.e15;
+    const float eMax = shape.eMax;
     m_eeClean_frac51.push_back( e51/e55 );
     m_eeClean_frac15.push_back( e15/e55 );
     m_eeClean_e55.push_back(e55);
     m_eeClean_eMax.push_back(eMax/e55);
-    m_eeClean_hcalIso.push_back( egIso.getHcalESum((*eeClean)[i].position()) );
+    m_eeClean_hcalIso.push_back( hcalIso((*eeClean)[i],egIso) );
 
     if ( !m_isData ) {
       m_eeClean_matchDR.push_back(eetagger.matchDR()[i]);
@@ -920,8 +1052,7 @@ MonoNtupleDumper::analyze(const edm::Event& iEvent, const edm::EventSetup& iSetu
 
   // unclean only clusters (EE)
   Handle<BasicClusterCollection> eeUnclean;
-  edm::InputTag eeUncleanTag("multi5x5SuperClusters","uncleanOnlyMulti5x5EndcapBasicClusters"); 
-  iEvent.getByLabel(eeUncleanTag,eeUnclean);
+  iEvent.getByLabel(m_clustTags[fEEUnclean],eeUnclean);
   const unsigned nEEUncleanClusters = eeUnclean->size();
 
   std::vector<const reco::CaloCluster *> eeUncleanClusters;
@@ -941,15 +1072,16 @@ MonoNtupleDumper::analyze(const edm::Event& iEvent, const edm::EventSetup& iSetu
     m_eeUnclean_eta.push_back( (*eeUnclean)[i].eta() );
     m_eeUnclean_phi.push_back( (*eeUnclean)[i].phi() );
 
-    const float e55 = ecalTool.e5x5((*eeUnclean)[i],eeRecHits.product(),topology);
-    const float e51 = ecalTool.e5x1((*eeUnclean)[i],eeRecHits.product(),topology);
-    const float e15 = ecalTool.e1x5((*eeUnclean)[i],eeRecHits.product(),topology);
-    const float eMax = ecalTool.eMax((*eeUnclean)[i],eeRecHits.product());
+    const Mono::MonoEcalShapeCache::Shape shape = m_shapes.shape((*eeUnclean)[i]);
+    const float e55 = shape.e55;
+    const float e51 = shape.e51;
+    const float e15 = shape.e15;
+    const float eMax = shape.eMax;
     m_eeUnclean_frac51.push_back( e51/e55 );
     m_eeUnclean_frac15.push_back( e15/e55 );
     m_eeUnclean_e55.push_back(e55);
     m_eeUnclean_eMax.push_back(eMax/e55);
-    m_eeUnclean_hcalIso.push_back( egIso.getHcalESum((*eeUnclean)[i].position()) );
+    m_eeUnclean_hcalIso.push_back( hcalIso((*eeUnclean)[i],egIso) );
 
     if ( !m_isData ) {
       m_eeUnclean_matchDR.push_back(eetagger.matchDR()[i]);
@@ -961,8 +1093,7 @@ MonoNtupleDumper::analyze(const edm::Event& iEvent, const edm::EventSetup& iSetu
 
   // combined EE clusters
   Handle<BasicClusterCollection> eeComb;
-  edm::InputTag eeCombTag("uncleanEERecovered","uncleanEndcapBasicClusters"); 
-  iEvent.getByLabel(eeCombTag,eeComb);
+  iEvent.getByLabel(m_clustTags[fEECombined],eeComb);
   const unsigned nEECombClusters = eeComb->size();
 
   std::vector<const reco::CaloCluster *> eeCombClusters;
@@ -982,17 +1113,18 @@ MonoNtupleDumper::analyze(const edm::Event& iEvent, const edm::EventSetup& iSetu
     m_eeComb_eta.push_back( (*eeComb)[i].eta() );
     m_eeComb_phi.push_back( (*eeComb)[i].phi() );
 
-    const float e55 = ecalTool.e5x5((*eeComb)[i],eeRecHits.product(),topology);
-    const float e51 = ecalTool.e5x1((*eeComb)[i],eeRecHits.product(),topology);
-    const float e15 = ecalTool.e1x5((*eeComb)[i],eeRecHits.product(),topology);
-    const float eMax = ecalTool.eMax((*eeComb)[i],eeRecHits.product());
+    const Mono::MonoEcalShapeCache::Shape shape = m_shapes.shape((*eeComb)[i],true);
+    const float e55 = shape.e55;
+    const float e51 = shape.e51;
+    const float e15 = shape.e15;
+    const float eMax = shape.eMax;
     m_eeComb_frac51.push_back( e51/e55 );
     m_eeComb_frac15.push_back( e15/e55 );
     m_eeComb_e55.push_back(e55);
     m_eeComb_eMax.push_back(eMax/e55);
-    m_eeComb_e25Right.push_back(ecalTool.e2x5Right((*eeComb)[i],eeRecHits.product(),topology));
-    m_eeComb_e25Left.push_back(ecalTool.e2x5Left((*eeComb)[i],eeRecHits.product(),topology));
-    m_eeComb_hcalIso.push_back( egIso.getHcalESum((*eeComb)[i].position()) );
+    m_eeComb_e25Right.push_back(shape.e25Right);
+    m_eeComb_e25Left.push_back(shape.e25Left);
+    m_eeComb_hcalIso.push_back( hcalIso((*eeComb)[i],egIso) );
 
     if ( !m_isData ) {
       m_eeComb_matchDR.push_back(eetagger.matchDR()[i]);
@@ -1001,13 +1133,14 @@ MonoNtupleDumper::analyze(const edm::Event& iEvent, const edm::EventSetup& iSetu
     }
   }
   m_nCombEE = nClusterCount;
+
+  m_clusterWatch.Stop();
   
 
 
 
   ////////////////////////////////
-  // Tracking analysis
-  _Tracker->analyze(iEvent, iSetup);
+  // match the tracks to the clusters
   //const Mono::MonoEcalCluster * clusters = clusterBuilder.clusters(); 
   //_Tracker->doMatch(m_nClusters,clusters,ebMap);
   _Tracker->doMatch(m_nCombEgamma,&ebClusters[0],fEBCombined);
@@ -1168,8 +1301,11 @@ MonoNtupleDumper::analyze(const edm::Event& iEvent, const edm::EventSetup& iSetu
   //
   rematch();
 
+  // RecHit branches, around the candidates in ROI mode
+  fillRecHits(*ecalRecHits,iSetup);
+
   // fill tree, must go last in this function
-  m_tree->Fill();
+  m_writer.fill();
 
 }
 
@@ -1180,6 +1316,8 @@ MonoNtupleDumper::beginJob()
 {
   m_outputFile = new TFile(m_output.c_str(), "recreate");
 
+  m_dEdXSig.setup(m_dEdXProb,m_dEdXTableHits);
+
   //m_avgDir = new TFileDirectory( m_fs->mkdir("avgClusterMaps"));
 
   m_tree = new TTree("monopoles","Monopole Variables");
@@ -1190,8 +1328,25 @@ MonoNtupleDumper::beginJob()
 
   m_tree->Branch("NPV",&m_NPV,"NPV/i");
 
-  m_tree->Branch("trigResult",&m_trigResults);
-  m_tree->Branch("trigNames",&m_trigNames);
+  m_tree->Branch("trigMenu",&m_trigMenu,"trigMenu/i");
+  m_tree->Branch("trigBits",&m_trigBits);
+
+  // read back with Mono::MonoTriggerMenu
+  m_menuTree = new TTree("triggerMenus","HLT menus by trigMenu id");
+  // in memory until endJob, only the writer thread writes to the file
+  m_menuTree->SetDirectory(0);
+  m_menuTree->Branch("menu",&m_trigMenu,"menu/i");
+  m_menuTree->Branch("run",&m_menuRun,"run/i");
+  m_menuTree->Branch("tableName",&m_menuTable);
+  m_menuTree->Branch("names",&m_menuNames);
+
+  if ( m_filter ) {
+    m_countTree = new TTree("runCounts","Events processed and accepted by the filter mode per run");
+    m_countTree->SetDirectory(0);
+    m_countTree->Branch("run",&m_countRun,"run/i");
+    m_countTree->Branch("processed",&m_runProcessed,"processed/i");
+    m_countTree->Branch("accepted",&m_runAccepted,"accepted/i");
+  }
 
   // combined candidates
   m_tree->Branch("cand_N",&m_nCandidates,"cand_N/i");
@@ -1238,8 +1393,9 @@ MonoNtupleDumper::beginJob()
   m_tree->Branch("clust_hsWeird",&m_clust_hsWeird);
   m_tree->Branch("clust_hsDiWeird",&m_clust_hsDiWeird);
   if(_ClustHitOutput){
-    m_tree->Branch("clust_Ecells",&m_clust_Ecells,"clust_Ecells[1500]/D");
-    m_tree->Branch("clust_Tcells",&m_clust_Tcells,"clust_Tcells[1500]/D");
+    m_tree->Branch("clust_cellBegin",&m_clust_cellBegin);
+    m_tree->Branch("clust_Ecells",&m_clust_Ecells);
+    m_tree->Branch("clust_Tcells",&m_clust_Tcells);
   }
 
   m_tree->Branch("egClust_N",&m_nCleanEgamma,"egClust_N/i");
@@ -1338,6 +1494,14 @@ MonoNtupleDumper::beginJob()
     m_tree->Branch("ehit_kWeird",&m_ehit_kWeird);
     m_tree->Branch("ehit_kDiWeird",&m_ehit_kDiWeird);
     m_tree->Branch("ehit_flag",&m_ehit_flag);
+
+    if ( m_roiOutput ) {
+      m_tree->Branch("roi_eta",&m_roi_eta);
+      m_tree->Branch("roi_phi",&m_roi_phi);
+      m_tree->Branch("roi_type",&m_roi_type);
+      m_tree->Branch("tower_idx",&m_tower_idx);
+      m_tree->Branch("tower_E",&m_tower_E);
+    }
   }
 
   _Tracker->beginJob(m_tree);
@@ -1418,14 +1582,42 @@ MonoNtupleDumper::beginJob()
   m_tree->Branch("amonExp_phi",&m_amonExp_phi, "amonExp_phi/D");
   }
 
+  // all branches are made
+  m_writer.bind<std::vector<MplTrackRecord> >("Track");
+  m_writer.start(m_tree);
 }
 
 // ------------ method called once each job just after ending the event loop  ------------
 void 
 MonoNtupleDumper::endJob() 
 {
+  m_writer.stop();
+  edm::LogInfo("MonoNtupleDumper") << m_writer.entries() << " events written with queue depth " << m_writer.depth()
+                                   << ": " << m_writer.writeTime() << " s filling, " << m_writer.stallTime()
+                                   << " s stalled on a full queue";
+
   m_outputFile->cd();
   m_tree->Write();
+  m_menuTree->SetDirectory(m_outputFile);
+  m_menuTree->Write();
+  if ( m_countTree ) {
+    m_countTree->SetDirectory(m_outputFile);
+    m_countTree->Write();
+  }
+
+  // what the RecHit branches kept, one entry
+  if ( m_roiOutput ) {
+    unsigned towerCrystals = 5, nTowerPhi = 72;
+    TTree *roiTree = new TTree("recHitROI","RecHits kept within |deta|, |dphi| < half widths of roi_eta, roi_phi;"
+                                          " tower_idx = (tower ieta from 0)*nTowerPhi + tower iphi from 0");
+    roiTree->Branch("etaHalfWidth",&m_roiEtaHalfWidth,"etaHalfWidth/D");
+    roiTree->Branch("phiHalfWidth",&m_roiPhiHalfWidth,"phiHalfWidth/D");
+    roiTree->Branch("clusterEnergy",&m_roiClusterE,"clusterEnergy/D");
+    roiTree->Branch("towerCrystals",&towerCrystals,"towerCrystals/i");
+    roiTree->Branch("nTowerPhi",&nTowerPhi,"nTowerPhi/i");
+    roiTree->Fill();
+    roiTree->Write();
+  }
 
   for(std::map<Mono::ClustCategorizer,TH2D*>::iterator i = m_clustEMap.begin(); i != m_clustEMap.end(); i++)
   {
@@ -1438,13 +1630,80 @@ MonoNtupleDumper::endJob()
 
   _Tracker->endJob();
 
+  if ( m_hcalIsoChecks )
+    edm::LogInfo("MonoNtupleDumper") << "HCAL isolation grid - exact over " << m_hcalIsoChecks << " clusters: mean |diff| "
+                                     << m_hcalIsoSumDiff/m_hcalIsoChecks << " GeV, max " << m_hcalIsoMaxDiff << " GeV";
+
+  if ( m_nClusterEvents )
+    edm::LogInfo("MonoNtupleDumper") << "Cluster collections: " << 1e3*m_clusterWatch.CpuTime()/m_nClusterEvents
+                                     << " ms cpu per event over " << m_nClusterEvents << " events";
+
   m_outputFile->Close();
 }
 
 // ------------ method called when starting to processes a run  ------------
 void 
-MonoNtupleDumper::beginRun(edm::Run const&, edm::EventSetup const&)
+MonoNtupleDumper::beginRun(edm::Run const& iRun, edm::EventSetup const& iSetup)
+{
+  m_countRun = iRun.run();
+  m_runProcessed = 0;
+  m_runAccepted = 0;
+
+  // keeps the table name current; the menu itself is set from
+  // the trigger names of the first event with a new one
+  bool changed = false;
+  if ( !m_hltConfig.init(iRun,iSetup,m_hltResults.process(),changed) )
+    edm::LogWarning("MonoNtupleDumper") << "No HLT configuration for process " << m_hltResults.process()
+                                        << " in run " << iRun.run() << ", trigger menus keyed by parameter set id.";
+}
+
+
+double
+MonoNtupleDumper::hcalIso(const reco::CaloCluster &cluster, const EgammaHcalIsolation &egIso)
 {
+  // the cone of egIso: 0.1 < dR < 0.4
+  const math::XYZPoint & pos = cluster.position();
+  if ( m_hcalIsoMode == kHcalIsoGrid ) return m_hcalGrid.cone(pos.eta(),pos.phi(),0.4,0.1);
+
+  const double exact = egIso.getHcalESum(pos);
+  if ( m_hcalIsoMode == kHcalIsoCheck ) {
+    const double diff = std::fabs(m_hcalGrid.cone(pos.eta(),pos.phi(),0.4,0.1)-exact);
+    m_hcalIsoChecks++;
+    m_hcalIsoSumDiff += diff;
+    m_hcalIsoMaxDiff = std::max(m_hcalIsoMaxDiff,diff);
+  }
+  return exact;
+}
+
+
+void
+MonoNtupleDumper::setTriggerMenu(const edm::TriggerNames &names)
+{
+  m_trigPSetID = names.parameterSetID();
+  m_NTrigs = names.size();
+
+  std::string key;
+  if ( m_hltConfig.inited() && m_hltConfig.triggerNames() == names.triggerNames() )
+    key = m_hltConfig.tableName();
+  else {
+    std::ostringstream id;
+    id << m_trigPSetID;
+    key = id.str();
+  }
+
+  std::map<std::string,unsigned>::const_iterator menu = m_menuIds.find(key);
+  if ( menu != m_menuIds.end() ) {
+    m_trigMenu = menu->second;
+    return;
+  }
+
+  m_trigMenu = m_menuIds.size();
+  m_menuIds[key] = m_trigMenu;
+
+  m_menuRun = m_run;
+  m_menuTable = key;
+  m_menuNames = names.triggerNames();
+  m_menuTree->Fill();
 }
 
 
@@ -1483,10 +1742,9 @@ void MonoNtupleDumper::clear()
     m_clust_hsInSeed.clear();
     m_clust_hsWeird.clear();
     m_clust_hsDiWeird.clear();
-    for ( unsigned i=0; i != SS; i++ ){
-      m_clust_Ecells[i] = -999.;
-      m_clust_Tcells[i] = -999.;
-    }
+    m_clust_cellBegin.assign(1,0);
+    m_clust_Ecells.clear();
+    m_clust_Tcells.clear();
 
 
     m_nClusterEgamma = 0;
@@ -1586,6 +1844,11 @@ void MonoNtupleDumper::clear()
     m_ehit_kWeird.clear();
     m_ehit_kDiWeird.clear();
     m_ehit_flag.clear();
+    m_roi_eta.clear();
+    m_roi_phi.clear();
+    m_roi_type.clear();
+    m_tower_idx.clear();
+    m_tower_E.clear();
 
     // Jet information
     m_jet_N = 0;
@@ -1677,109 +1940,136 @@ void MonoNtupleDumper::clear()
 
 }
 
-void MonoNtupleDumper::rematch()
+bool MonoNtupleDumper::preselect(const edm::Event &iEvent)
 {
+  // a track rematch() could make a candidate of, with a large dE/dx
+  const std::vector<MplTrackRecord> & sets = _Tracker->getRecords();
+  for ( unsigned i=0; i != sets.size(); i++ )
+    if ( sets[i].Ndof > 3 && dEdXSig(sets[i]) > m_preselDeDxSig ) return true;
+
+  // else a narrow cluster of the collections candidates are made of,
+  // from the shape cache alone
+  const EcalClustID ids[2] = { m_candEB.id, m_candEE.id };
+  for ( unsigned t=0; t != 2; t++ ) {
+    edm::Handle<reco::BasicClusterCollection> clusters;
+    iEvent.getByLabel(m_clustTags[ids[t]],clusters);
+    for ( unsigned i=0; i != clusters->size(); i++ ) {
+      const Mono::MonoEcalShapeCache::Shape shape = m_shapes.shape((*clusters)[i]);
+      if ( shape.e55 > 0.f && shape.e51/shape.e55 > m_preselFrac51 ) return true;
+    }
+  }
 
+  return false;
+}
 
-  const double EcalR = 129.0;
 
-  // Get a handle on the monopole tracks
-  std::vector<Mono::MonoTrack> tracks;
-  _Tracker->getTracks(tracks);
+void MonoNtupleDumper::fillRecHits(const EBRecHitCollection &hits, const edm::EventSetup &iSetup)
+{
+  if ( m_roiOutput ) {
+    for ( unsigned i=0; i != m_candEta.size(); i++ ) {
+      m_roi_eta.push_back( m_candEta[i] );
+      m_roi_phi.push_back( m_candPhi[i] );
+      m_roi_type.push_back( 0 );
+    }
+    for ( unsigned i=0; i != m_egComb_E.size(); i++ ) {
+      if ( m_egComb_E[i] < m_roiClusterE ) continue;
+      m_roi_eta.push_back( m_egComb_eta[i] );
+      m_roi_phi.push_back( m_egComb_phi[i] );
+      m_roi_type.push_back( 1 );
+    }
+  }
 
-  const std::vector<int> & subHits = _Tracker->getSubHits();
-  const std::vector<int> & satSubHits = _Tracker->getSatSubHits();
-  const std::vector<float> & tIso = _Tracker->getTIso();
-  const std::vector<float> & nDof = _Tracker->getNdof();
+  const Mono::MonoEcalGeomTable::Cells & ebCells = Mono::MonoEcalGeomTable::shared(iSetup).eb();
+  EBRecHitCollection::const_iterator itHit = hits.begin();
+  for ( ; itHit != hits.end(); itHit++ ) {
 
-  const unsigned nTracks = tracks.size();
+    const EBDetId id( (*itHit).id() );
+    const unsigned idx = id.hashedIndex();
 
-  for(unsigned i=0; i < nTracks; i++){
+    if ( m_roiOutput ) {
+      bool inside = false;
+      for ( unsigned r=0; r != m_roi_eta.size() && !inside; r++ )
+        inside = std::fabs(ebCells.eta[idx]-m_roi_eta[r]) < m_roiEtaHalfWidth
+              && std::fabs(reco::deltaPhi(ebCells.phi[idx],m_roi_phi[r])) < m_roiPhiHalfWidth;
 
-    // if Ndof <= 3 continue
-    if ( nDof[i] <= 3 ) continue;
-
-    const Mono::MonoTrack & tr = tracks[i];
-
-    // Calculate expected Eta, Phi for ECAL cluster
-    float ThisZ = tr.rzp0() + EcalR*tr.rzp1() + EcalR*EcalR*tr.rzp2();
-    float ThisEta = TMath::ASinH(ThisZ / EcalR);
-    float ThisPhi = tr.xyp1() - TMath::ASin((EcalR*EcalR-tr.xyp0()*tr.xyp2())/(2*EcalR*(tr.xyp2()-tr.xyp0())));
-
-    float MinDR = 999;
-    int BestEBCluster=-1, BestEECluster=-1;
-    const unsigned nEBclusters = m_nCombEgamma;
-    for(unsigned j=0; j < nEBclusters; j++){
-      float DEta = ThisEta-m_egComb_eta[j];
-      float DPhi = ThisPhi-m_egComb_phi[j];
-      while(DPhi < -3.14159) DPhi += 2*3.14159;
-      while(DPhi >  3.14159) DPhi -= 2*3.14159;
-
-      float ThisDR = sqrt(pow(DEta,2) + pow(DPhi,2));
-      if(ThisDR < MinDR){
-        MinDR = ThisDR;
-        BestEBCluster = j;
+      if ( !inside ) {
+        const int tEta = id.tower_ieta();
+        m_towerSum[(tEta < 0 ? tEta+17 : tEta+16)*72 + id.tower_iphi()-1] += (*itHit).energy();
+        continue;
       }
     }
 
-    const unsigned nEEclusters = m_nCombEE;
-    for(unsigned j=0; j < nEEclusters; j++){
-      float DEta = ThisEta-m_eeComb_eta[j];
-      float DPhi = ThisPhi-m_eeComb_phi[j];
-      while(DPhi < -3.14159) DPhi += 2*3.14159;
-      while(DPhi >  3.14159) DPhi -= 2*3.14159;
-
-      float ThisDR = sqrt(pow(DEta,2) + pow(DPhi,2));
-      if(ThisDR < MinDR){
-        MinDR = ThisDR;
-        BestEECluster = j;
-        BestEBCluster = -1;
-      }
-    }
+    m_ehit_eta.push_back( ebCells.eta[idx] );
+    m_ehit_phi.push_back( ebCells.phi[idx] );
+    m_ehit_energy.push_back( (*itHit).energy() );
+    m_ehit_time.push_back( (*itHit).time() );
+    m_ehit_otEnergy.push_back( (*itHit).outOfTimeEnergy() );
+
+    m_ehit_kWeird.push_back( (*itHit).checkFlag(EcalRecHit::kWeird) );
+    m_ehit_kDiWeird.push_back( (*itHit).checkFlag(EcalRecHit::kDiWeird) );
+    m_ehit_flag.push_back( (*itHit).recoFlag() );
+
+  }
+
+  // the towers outside the windows, sparse
+  for ( unsigned t=0; t != m_towerSum.size(); t++ ) {
+    if ( m_towerSum[t] == 0.f ) continue;
+    m_tower_idx.push_back( t );
+    m_tower_E.push_back( m_towerSum[t] );
+    m_towerSum[t] = 0.f;
+  }
+}
+
+
+void MonoNtupleDumper::rematch()
+{
+  // the matches were made by doMatch, on the impact points
+  // of the tracks on the EB and EE surfaces
+  const std::vector<MplTrackRecord> & sets = _Tracker->getRecords();
 
-    // fill place holders of matches
-    int matchEB = BestEBCluster;
-    int matchEE = BestEECluster;
-    double distEB = BestEBCluster >= 0 ? MinDR : 999;
-    double distEE = BestEECluster >= 0 ? MinDR : 999;
+  const unsigned nTracks = sets.size();
 
-    // continue to next track if match = -1
+  for(unsigned i=0; i < nTracks; i++){
+
+    const MplTrackRecord & set = sets[i];
+
+    // if Ndof <= 3 continue
+    if ( set.Ndof <= 3 ) continue;
+
+    // continue to next track if there is no match
+    const int matchEB = set.ClustMatch[m_candEB.id];
+    const int matchEE = set.ClustMatch[m_candEE.id];
     if ( matchEB == -1 && matchEE == -1 ) continue;
 
+    // the nearer of the two, unmatched distances are 999
+    const bool barrel = set.ClustDist[m_candEB.id] < set.ClustDist[m_candEE.id];
+    const CandidateClusters & clusters = barrel ? m_candEB : m_candEE;
+    const int match = barrel ? matchEB : matchEE;
+
     // calculate dE/dX significance
-    const double dEdXSig = sqrt(-TMath::Log(TMath::BinomialI(0.07, subHits[i], satSubHits[i])));
+    const double dEdXSig = this->dEdXSig(set);
  
     /////////////////////////////////////////
     // assign values to branches
     m_nCandidates++;
-    m_candSubHits.push_back( subHits[i] );
-    m_candSatSubHits.push_back( satSubHits[i] );
+    m_candSubHits.push_back( set.SubHits );
+    m_candSatSubHits.push_back( set.SatSubHits );
     m_canddEdXSig.push_back( dEdXSig );
-    m_candTIso.push_back( tIso[i] );
-    m_candXYPar0.push_back( tr.xyp0() );
-    m_candXYPar1.push_back( tr.xyp1() );
-    m_candXYPar2.push_back( tr.xyp2() );
-    m_candRZPar0.push_back( tr.rzp0() );
-    m_candRZPar1.push_back( tr.rzp1() );
-    m_candRZPar2.push_back( tr.rzp2() );
-
-    if ( distEB < distEE ) {
-      m_candDist.push_back( distEB );
-      m_candSeedFrac.push_back( m_egComb_frac51[matchEB] );
-      m_candf15.push_back( m_egComb_frac15[matchEB] );
-      m_candE55.push_back( m_egComb_e55[matchEB] );
-      m_candHIso.push_back( m_egComb_hcalIso[matchEB] );
-      m_candEta.push_back( m_egComb_eta[matchEB] );
-      m_candPhi.push_back( m_egComb_phi[matchEB] );
-    } else {
-      m_candDist.push_back( distEE );
-      m_candSeedFrac.push_back( m_eeComb_frac51[matchEE] );
-      m_candf15.push_back( m_eeComb_frac15[matchEE] );
-      m_candE55.push_back( m_eeComb_e55[matchEE] );
-      m_candHIso.push_back( m_eeComb_hcalIso[matchEE] );
-      m_candEta.push_back( m_eeComb_eta[matchEE] );
-      m_candPhi.push_back( m_eeComb_phi[matchEE] );
-    }
+    m_candTIso.push_back( set.Iso );
+    m_candXYPar0.push_back( set.XYPar[0] );
+    m_candXYPar1.push_back( set.XYPar[1] );
+    m_candXYPar2.push_back( set.XYPar[2] );
+    m_candRZPar0.push_back( set.RZPar[0] );
+    m_candRZPar1.push_back( set.RZPar[1] );
+    m_candRZPar2.push_back( set.RZPar[2] );
+
+    m_candDist.push_back( set.ClustDist[clusters.id] );
+    m_candSeedFrac.push_back( (*clusters.frac51)[match] );
+    m_candf15.push_back( (*clusters.frac15)[match] );
+    m_candE55.push_back( (*clusters.e55)[match] );
+    m_candHIso.push_back( (*clusters.hcalIso)[match] );
+    m_candEta.push_back( (*clusters.eta)[match] );
+    m_candPhi.push_back( (*clusters.phi)[match] );
 
  }
 }
@@ -1790,6 +2080,12 @@ void MonoNtupleDumper::rematch()
 void 
 MonoNtupleDumper::endRun(edm::Run const&, edm::EventSetup const&)
 {
+  if ( m_countTree ) {
+    m_countTree->Fill();
+    edm::LogInfo("MonoNtupleDumper") << "Run " << m_countRun << ": " << m_runAccepted << " of "
+                                     << m_runProcessed << " events pass the preselection";
+  }
+
   //m_ecalCalib.calculateHij();
   //m_ecalCalib.dumpCalibration();
 
@@ -0,0 +1,51 @@
+#ifndef Monopoles_MplDeDx_H
+#define Monopoles_MplDeDx_H
+
+//////////////////////////////////////////////////////////////
+// dE/dx estimators of a monopole track candidate from the
+// normalised hit charges.  The charges are copied once into a
+// buffer that is kept between candidates, and the order
+// statistics use std::nth_element on it instead of sorting.
+//
+//  Median         upper median, as the old FitDeDx
+//  TruncatedMean  mean after dropping the highest fraction
+//  Harmonic2      (sum q^-2 / n)^-1/2
+//  LandauMPV      unbinned maximum likelihood MPV, using the
+//                 Moyal approximation of the Landau density
+//
+// Charges <= 0 (pixels, unread clusters) are ignored; every
+// estimator returns 0 without charges.
+//////////////////////////////////////////////////////////////
+
+#include <vector>
+#include <string>
+
+class MplDeDxEstimator {
+  public:
+    enum Estimator { kMedian=0, kTruncatedMean, kHarmonic2, kLandauMPV, kNEstimators };
+
+    static const char *Name(int Estimator);
+    // estimator of a name, -1 if unknown
+    static int Find(const std::string &Name);
+
+    MplDeDxEstimator(float Truncation=0.4);
+
+    // start a candidate
+    inline void Clear() { _Charges.clear(); }
+    inline void Add(float Charge) { if(Charge > 0) _Charges.push_back(Charge); }
+    inline unsigned N() const { return _Charges.size(); }
+
+    // the estimators in Mask (bit i for estimator i) into Values[i], others untouched
+    void Compute(unsigned Mask, float *Values);
+
+    float Median();
+    float TruncatedMean();
+    float Harmonic2() const;
+    float LandauMPV() const;
+
+  private:
+    float _Truncation;
+    std::vector<float> _Charges;
+};
+
+#endif
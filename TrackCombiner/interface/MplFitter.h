@@ -0,0 +1,75 @@
+#ifndef Monopoles_MplFitter_H
+#define Monopoles_MplFitter_H
+
+//////////////////////////////////////////////////////////////
+// Closed-form weighted least-squares fits for monopole track
+// candidates.  Both fits return their parameters in the same
+// convention as the TF1 formulae used by MplTracker, so the
+// ROOT fit can be kept as a drop-in cross-check:
+//
+//  RZ: z = p0 + p1*r + p2*r^2
+//  XY: y = p0 + sqrt(p2^2 - (x-p1)^2)*sign(p2) - p2
+//
+// The fitters do not depend on CMSSW or ROOT.
+//////////////////////////////////////////////////////////////
+
+struct MplFitResult {
+  double Par[3];
+  double Err[3];
+  double Cov[3][3];
+  double Chi2;
+  int Ndof;
+  bool Valid;
+
+  void Reset(int n);
+};
+
+// Running weighted sums for the linearised fits.  Adding a hit is O(1),
+// and the struct is a plain value so a trial addition is undone by
+// copying back a snapshot.  The XY sums are taken about the first hit,
+// rotated so the track runs along u from there, and the XY chi2 is that
+// of v = a q + b u + c with q = u^2+v^2: an algebraic distance that stays
+// close to the geometric one up to a straight line.  The RZ chi2 is exact
+// for the given weights.
+struct MplFitMoments {
+  // RZ: sum w u^k (k=0..4), sum w z u^k (k=0..2), sum w z^2, u = r/RScale
+  double SR[5], SZR[3], SZZ;
+  // XY: first hit and the rotation to its azimuth
+  double X0, Y0, Cos0, Sin0;
+  // XY: weighted sums of 1, u, v, uu, uv, vv, q, qu, qv, qq, all in RScale
+  double Sw, Su, Sv, Suu, Suv, Svv, Sq, Squ, Sqv, Sqq;
+  unsigned N;
+
+  static const double RScale;
+
+  void Reset();
+  void Add(double x, double y, double wxy, double z, double wz);
+
+  inline int Ndof() const { return int(N) - 3; }
+  double Chi2RZ() const;
+  double Chi2XY() const;
+};
+
+namespace MplFit {
+
+  // invert a symmetric 3x3 matrix, returns false if it is singular
+  bool Invert3(const double M[3][3], double Inv[3][3]);
+
+  // Weighted parabola fit in the RZ plane.  The r errors are folded in
+  // through one effective-variance pass using the slope of the first pass.
+  void FitParabola(unsigned n, const double *r, const double *z,
+                   const double *er, const double *ez, MplFitResult &Res);
+
+  // radius given to a track fitted with no curvature
+  const double MaxRadius = 1e8;
+
+  // Karimaki circle fit in the XY plane, in curvature, direction and
+  // distance about the hit centroid so nearly straight tracks stay well
+  // defined, followed by one Gauss-Newton step on the geometric distances.
+  // The curvature is capped at 1/MaxRadius for the (p0, p1, p2) output.
+  void FitCircle(unsigned n, const double *x, const double *y,
+                 const double *ex, const double *ey, MplFitResult &Res);
+
+}
+
+#endif
@@ -0,0 +1,69 @@
+#ifndef Monopoles_MplGroupBuilder_H
+#define Monopoles_MplGroupBuilder_H
+
+//////////////////////////////////////////////////////////////
+// Adds candidate tracks to a monopole track group using the
+// running fit sums of MplFitMoments.  Candidates are tested in
+// index order and a candidate is kept if the group with it
+// still passes the chi2/ndof cut, as in the serial grouping.
+//
+// With more than one thread the next candidates are tested
+// against the current group in parallel, each task on its own
+// copy of the sums.  The first accepted candidate in index order
+// is committed and the candidates after it are tested again, so
+// the groups are identical to the serial ones for any thread
+// count.  A round tests a batch of BatchPerThread candidates per
+// thread rather than all the remaining ones, which bounds the
+// repeated tests to a batch per accepted candidate instead of
+// the whole list.  The builder does not start the threads: the
+// caller (MplTrackEngine) holds the TBB scheduler.
+//////////////////////////////////////////////////////////////
+
+#include "Monopoles/TrackCombiner/interface/MplFitter.h"
+#include "Monopoles/TrackCombiner/interface/MplHitCache.h"
+
+#include <vector>
+
+class MplGroupBuilder {
+  public:
+    MplGroupBuilder(float Chi2Cut, int NThreads=1);
+
+    // candidates per thread tested in one parallel round
+    static const unsigned BatchPerThread = 16;
+
+    inline int NThreads() const { return _NThreads; }
+
+    // add the fitted hits of a track to the sums (and hit list if given),
+    // returns the number of those also used for dE/dx; a track without any
+    // is not added
+    static int AddTrackHits(const MplHitCache &Cache, unsigned iTrack, float SeedSlope,
+                            MplFitMoments &Moments, std::vector<unsigned> *Hits=0);
+
+    // chi2/ndof cut on the sums
+    bool Accept(const MplFitMoments &Moments) const;
+
+    // test the candidates (in index order) not flagged in Used, append the
+    // accepted ones to Group and their hits to Moments and Hits
+    void AddCandidates(const MplHitCache &Cache, const std::vector<int> &Candidates,
+                       const std::vector<bool> &Used, float SeedSlope,
+                       MplFitMoments &Moments, std::vector<unsigned> &Hits,
+                       std::vector<int> &Group);
+
+  private:
+    void AddSerial(const MplHitCache &Cache, const std::vector<int> &Candidates,
+                   const std::vector<bool> &Used, float SeedSlope,
+                   MplFitMoments &Moments, std::vector<unsigned> &Hits,
+                   std::vector<int> &Group) const;
+    void AddParallel(const MplHitCache &Cache, const std::vector<int> &Candidates,
+                     const std::vector<bool> &Used, float SeedSlope,
+                     MplFitMoments &Moments, std::vector<unsigned> &Hits,
+                     std::vector<int> &Group);
+
+    float _Chi2Cut;
+    int _NThreads;
+
+    // per candidate result of the last parallel round
+    std::vector<char> _Accepted;
+};
+
+#endif
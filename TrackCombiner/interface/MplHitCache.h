@@ -0,0 +1,74 @@
+#ifndef Monopoles_MplHitCache_H
+#define Monopoles_MplHitCache_H
+
+//////////////////////////////////////////////////////////////
+// Per-event record of the tracker hits on the tracks used by
+// MplTracker.  Each valid hit is transformed and its cluster
+// read exactly once per event; the hit output, AddPoints and
+// every trial in AddMoreTracks only index into these arrays.
+// The hits of track i are [TrackBegin[i], TrackBegin[i+1]).
+//////////////////////////////////////////////////////////////
+
+#include <vector>
+
+struct MplHitCache {
+  std::vector<unsigned> TrackBegin;
+
+  // global position and error (ErrValid is 0 if the local error was invalid)
+  std::vector<float> X, Y, Z;
+  std::vector<float> Cxx, Cyx, Cyy, Czz;
+  std::vector<char> ErrValid;
+
+  // strip cluster: number of strips, saturated strips and ADC sum (-1 for pixels)
+  std::vector<int> Strips, SatStrips;
+  std::vector<float> Charge;
+
+  // MeV/ADC over the module thickness and path length cosine
+  std::vector<float> Norm, Cosine;
+
+  // errors used in the fits (fudged or defaulted) and the hit selection:
+  // Fit hits enter the XY and RZ fits, Use hits also the dE/dx and the hit
+  // counts (a hit with a saturated core is fitted but not counted)
+  std::vector<float> FitCxx, FitCyx, FitCyy, FitCzz;
+  std::vector<float> NormCharge;
+  std::vector<char> Fit, Use;
+
+  inline unsigned NHits() const { return X.size(); }
+  inline unsigned NTracks() const { return TrackBegin.empty() ? 0 : TrackBegin.size()-1; }
+  inline unsigned Begin(unsigned Track) const { return TrackBegin[Track]; }
+  inline unsigned End(unsigned Track) const { return TrackBegin[Track+1]; }
+
+  inline float Perp2(unsigned h) const { return X[h]*X[h] + Y[h]*Y[h]; }
+
+  // radial component of the fit error
+  inline float FitRErr2(unsigned h) const {
+    const float r2 = Perp2(h);
+    if(r2 <= 0) return 0;
+    return (X[h]*X[h]*FitCxx[h] + 2*X[h]*Y[h]*FitCyx[h] + Y[h]*Y[h]*FitCyy[h]) / r2;
+  }
+
+  inline void Resize(unsigned n){
+    X.resize(n); Y.resize(n); Z.resize(n);
+    Cxx.resize(n); Cyx.resize(n); Cyy.resize(n); Czz.resize(n);
+    ErrValid.resize(n);
+    Strips.resize(n); SatStrips.resize(n); Charge.resize(n);
+    Norm.resize(n); Cosine.resize(n);
+    FitCxx.resize(n); FitCyx.resize(n); FitCyy.resize(n); FitCzz.resize(n);
+    NormCharge.resize(n);
+    Fit.resize(n); Use.resize(n);
+  }
+
+  // append one hit, returns its index
+  inline unsigned Add(){
+    const unsigned h = NHits();
+    Resize(h+1);
+    return h;
+  }
+
+  inline void Clear(){
+    TrackBegin.clear();
+    Resize(0);
+  }
+};
+
+#endif
@@ -0,0 +1,133 @@
+#ifndef Monopoles_MplHoughFinder_H
+#define Monopoles_MplHoughFinder_H
+
+//////////////////////////////////////////////////////////////
+// Hough-transform search for monopoles directly on the
+// saturated strip hits of an event, for the monopoles that the
+// helix-based pattern recognition breaks up or misses.
+//
+//  XY: circle through the origin, phi = Phi0 + asin(Curv*r/2);
+//      a hit votes once per Curv bin in a (Phi0, Curv) grid
+//  RZ: z = Z0 + Slope*r + RZCurv*r^2 for the hits on an XY
+//      peak; one hit does not fix the slope for a given
+//      (Z0, RZCurv), so it votes once per (Z0, RZCurv) bin in
+//      the slope (angle) bin through it
+//
+// The Phi0 range is cut into sectors, each with its own small
+// [phi][curv] accumulator (the votes of one hit land next to
+// each other) and reading the hits binned by phi, so sectors
+// run in parallel and share nothing but the input.  Peaks are
+// refined with the parabola fit of MplFitter: the worst hit is
+// dropped until all are within the pull cut, then hits of the
+// XY road on the fitted parabola are taken back.  MplTrackEngine resolves
+// hits claimed by several candidates and fits them like the
+// combined tracks.
+//////////////////////////////////////////////////////////////
+
+#include "Monopoles/TrackCombiner/interface/MplHitCache.h"
+#include "Monopoles/TrackCombiner/interface/MplFitter.h"
+
+#include <vector>
+#include <string>
+
+struct MplHoughConfig {
+  MplHoughConfig();
+
+  // off by default: the strip hits of the whole event have to be read
+  bool Enable;
+
+  // strip rechit collections as "label:instance", read by MplTrackFinder
+  std::vector<std::string> Sources;
+
+  // hit selection on the saturated strip count
+  float SatFraction;
+  int MinSatStrips;
+
+  // minimum votes of a peak and hits of a candidate
+  int MinHits;
+
+  // XY grid: Phi0 in [-pi, pi) cut into NSectors, Curv in [-MaxCurv, MaxCurv] (1/cm)
+  int NSectors, NPhi, NCurv;
+  float MaxCurv;
+
+  // RZ grid: Z0 in [-MaxZ0, MaxZ0] (cm), RZCurv in [-MaxRZCurv, MaxRZCurv]
+  // (1/cm) and atan(Slope) in (-pi/2, pi/2)
+  int NZ0, NRZCurv, NSlope;
+  float MaxZ0, MaxRZCurv;
+
+  // largest z residual/error of a hit to the refined parabola
+  float PullCut;
+
+  inline bool Select(int Strips, int SatStrips) const {
+    return SatStrips >= MinSatStrips && SatStrips >= SatFraction*Strips;
+  }
+};
+
+struct MplHoughCandidate {
+  // bin centres of the XY and RZ peaks
+  float Phi0, Curv;
+  float Z0, Slope, RZCurv;
+  unsigned Votes;
+
+  // hit cache indices after the refinement, ascending
+  std::vector<unsigned> Hits;
+};
+
+// accumulators and buffers of one Phi0 sector
+struct MplHoughSector {
+  // Phi0 bins [Begin, End), the accumulator has one more on each side
+  int Begin, End;
+  std::vector<unsigned short> XY;
+  std::vector<unsigned short> RZ;
+
+  // hits near the XY peak, and those also near the RZ peak
+  std::vector<unsigned> Road, Selected;
+  std::vector<double> FitX, FitY, FitEX, FitEY;
+
+  std::vector<MplHoughCandidate> Candidates;
+};
+
+class MplHoughFinder {
+  public:
+    // sectors run in parallel for NThreads > 1, on the TBB scheduler of
+    // the caller (MplTrackEngine)
+    MplHoughFinder(const MplHoughConfig &, int NThreads=1);
+
+    // candidates of prepared hits (fit errors set), in Phi0 order
+    void Find(const MplHitCache &Hits, std::vector<MplHoughCandidate> &Candidates);
+
+    // one sector, for the parallel loop; reads the binning of Find
+    void FindSector(const MplHitCache &Hits, MplHoughSector &S) const;
+
+  private:
+    MplHoughFinder(const MplHoughFinder &);
+    MplHoughFinder & operator=(const MplHoughFinder &);
+
+    void BinHits(const MplHitCache &Hits);
+    void VoteXY(MplHoughSector &S) const;
+    void CollectRoad(const MplHitCache &Hits, float Phi0, float Curv, int PhiBin, MplHoughSector &S) const;
+    bool VoteRZ(const MplHitCache &Hits, MplHoughSector &S, MplHoughCandidate &Cand) const;
+    void AngleBins(const MplHitCache &Hits, unsigned h, int iz, int ic, int &First, int &Last) const;
+    void Refine(const MplHitCache &Hits, MplHoughSector &S, MplHoughCandidate &Cand) const;
+    bool TrimRZ(const MplHitCache &Hits, MplHoughSector &S, MplFitResult &Res) const;
+
+    inline int PhiBin(float Phi) const;
+    inline float PhiCentre(int Bin) const;
+    inline float CurvCentre(int Bin) const;
+
+    const MplHoughConfig _Config;
+    int _NThreads;
+
+    float _PhiWidth, _CurvWidth, _Z0Width, _RZCurvWidth, _AngleWidth;
+
+    // hits counting-sorted by phi bin, their phi and r
+    std::vector<int> _BinStart, _BinFill;
+    std::vector<unsigned> _BinHits;
+    std::vector<float> _Phi, _R;
+    // phi bins a hit can be away from the Phi0 bins it votes for
+    int _Halo;
+
+    std::vector<MplHoughSector> _Sectors;
+};
+
+#endif
@@ -0,0 +1,85 @@
+#ifndef Monopoles_MplReplay_H
+#define Monopoles_MplReplay_H
+
+//////////////////////////////////////////////////////////////
+// Compact binary file of MplTrackEvents, to run MplTrackEngine
+// on recorded events without cmsRun.  Written by the
+// MplReplayDumper module, read by the test and bench programs.
+//
+// Layout, native byte order:
+//   "MPLR" uint32 version (1 or 2)
+//   per event:
+//     uint32 Run, Event, NTracks, NHits
+//     float Pt, Eta, Phi [NTracks]   int8 Charge [NTracks]
+//     uint32 hits per track [NTracks]
+//     float X, Y, Z, Cxx, Cyx, Cyy, Czz, NormCharge [NHits]
+//     uint16 Strips, SatStrips [NHits]   uint8 ErrValid [NHits]
+//     uint32 NSatHits, then the same hit arrays for the saturated
+//     hits of the Hough finder (version 2)
+//
+// Only the normalised charge is stored: a read event has Charge
+// equal to NormCharge and Norm = Cosine = 1.  The fit errors and
+// hit selection are not stored, MplTrackEngine::PrepareHits sets
+// them from the config used for the replay.
+//////////////////////////////////////////////////////////////
+
+#include "Monopoles/TrackCombiner/interface/MplTrackEngine.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+class MplReplayWriter {
+  public:
+    MplReplayWriter(const std::string &FileName);
+    ~MplReplayWriter();
+
+    inline bool Good() const { return _File != 0 && !_Error; }
+    inline unsigned NEvents() const { return _NEvents; }
+
+    void Write(const MplTrackEvent &Event);
+
+  private:
+    MplReplayWriter(const MplReplayWriter &);
+    MplReplayWriter & operator=(const MplReplayWriter &);
+
+    bool WriteHits(const MplHitCache &Hits);
+
+    FILE *_File;
+    bool _Error;
+    unsigned _NEvents;
+
+    // conversion buffers
+    std::vector<signed char> _Int8;
+    std::vector<unsigned short> _Int16;
+    std::vector<unsigned> _Int32;
+};
+
+class MplReplayReader {
+  public:
+    MplReplayReader(const std::string &FileName);
+    ~MplReplayReader();
+
+    // false if the file could not be opened, is not a replay file or is truncated
+    inline bool Good() const { return _File != 0 && !_Error; }
+
+    // next event, false at the end of the file or on an error
+    bool Read(MplTrackEvent &Event);
+
+  private:
+    MplReplayReader(const MplReplayReader &);
+    MplReplayReader & operator=(const MplReplayReader &);
+
+    // hit arrays into a cache already resized to their number
+    bool ReadHits(MplHitCache &Hits);
+
+    FILE *_File;
+    bool _Error;
+    unsigned _Version;
+
+    std::vector<signed char> _Int8;
+    std::vector<unsigned short> _Int16;
+    std::vector<unsigned> _Int32;
+};
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef Monopoles_MplReplayDumper_H
+#define Monopoles_MplReplayDumper_H
+
+#include "FWCore/Framework/interface/EDAnalyzer.h"
+
+#include "Monopoles/TrackCombiner/interface/MplTrackFinder.h"
+#include "Monopoles/TrackCombiner/interface/MplReplay.h"
+
+#include <string>
+
+// Writes the MplTrackEngine input of every event to an MplReplay file.
+// Takes the MplTracker parameters (TrackSource, TrackPtCut, ...); hits are
+// only stored for tracks above TrackPtCut, so replays need a cut at least
+// as tight.
+class MplReplayDumper: public edm::EDAnalyzer{
+  public:
+    MplReplayDumper(const edm::ParameterSet&);
+    virtual ~MplReplayDumper();
+
+    virtual void beginJob();
+    virtual void endJob();
+    virtual void analyze(const edm::Event&, const edm::EventSetup&);
+  private:
+    std::string _FileName;
+
+    MplTrackFinder _Finder;
+    MplTrackerInput *_Input;
+    MplReplayWriter *_Writer;
+};
+#endif
@@ -0,0 +1,245 @@
+#ifndef Monopoles_MplTrackEngine_H
+#define Monopoles_MplTrackEngine_H
+
+//////////////////////////////////////////////////////////////
+// Monopole track combination without CMSSW:
+//
+//  MplTrackerConfig     cuts and options, fixed after construction
+//  MplTrackEvent        plain-array input: tracks (pt, eta, phi,
+//                       charge) and their hits in an MplHitCache
+//  MplTrackerWorkspace  everything that changes during an event,
+//                       one per stream/thread, reused between events
+//  MplTrackerResult     the combined tracks of one event
+//  MplTrackEngine       const algorithm working on the above
+//
+// MplTrackFinder fills an MplTrackEvent from the edm::Event, and
+// MplReplay reads and writes it, so the same engine runs inside
+// cmsRun and on recorded events offline.
+//
+// With the Hough finder enabled, candidates found directly on the
+// saturated strip hits (MplHoughFinder) follow the combined tracks
+// in the result, in the same MplTrackSet form.
+//
+// With NThreads above one the engine holds the TBB scheduler of
+// the thread that builds it; the group builder and the Hough
+// finder of its workspaces only run their parallel loops on it.
+//////////////////////////////////////////////////////////////
+
+#include "Monopoles/TrackCombiner/interface/MplFitter.h"
+#include "Monopoles/TrackCombiner/interface/MplHitCache.h"
+#include "Monopoles/TrackCombiner/interface/MplGroupBuilder.h"
+#include "Monopoles/TrackCombiner/interface/MplDeDx.h"
+#include "Monopoles/TrackCombiner/interface/MplHoughFinder.h"
+
+#include <TF1.h>
+#include <TFitResultPtr.h>
+#include <TStopwatch.h>
+
+#include <vector>
+#include <string>
+
+namespace edm {
+  class ParameterSet;
+}
+
+namespace tbb {
+  class task_scheduler_init;
+}
+
+struct MplTrackerConfig {
+  // defaults of the EDM parameters
+  MplTrackerConfig();
+  // parameters named Prefix+"PhiCut" etc. (defined with the EDM adapter)
+  MplTrackerConfig(const edm::ParameterSet &, const std::string &Prefix="Track");
+
+  enum FitMode { kAnalyticFit=0, kRootFit, kValidateFit };
+
+  std::string Source;
+  float PhiCut, Chi2Cut, PtCut, DeDxCut, DefaultError, ErrorFudge;
+  float MeVperADCPixel, MeVperADCStrip;
+  int FitMode;
+  int NThreads;
+  bool TrackHitOutput;
+
+  // dE/dx estimators to compute (bit i for MplDeDxEstimator i) and the
+  // fraction of highest charges dropped by the truncated mean
+  unsigned DeDxMask;
+  float DeDxTruncation;
+
+  // loose pre-filter of the tracks above the pt cut on the strips of their
+  // hits, before any grouping or fit; off, the old behaviour, by default
+  bool SatFilter;
+  float SatFilterFraction;
+  int SatFilterMinStrips;
+
+  inline bool SatSelect(int Strips, int SatStrips) const {
+    return SatStrips >= SatFilterMinStrips && SatStrips >= SatFilterFraction*Strips;
+  }
+
+  // isolation cone and the eta-phi grid derived from it
+  float IsoCone;
+  int IsoNEta, IsoNPhi;
+
+  void SetIsoCone(float Cone);
+
+  // search on the saturated strip hits of the event
+  MplHoughConfig Hough;
+};
+
+// one event of input
+struct MplTrackEvent {
+  unsigned Run, Event;
+
+  std::vector<float> Pt, Eta, Phi;
+  std::vector<int> Charge;
+
+  // hits of the tracks above the pt cut: position, raw error, strips and
+  // NormCharge are input, the fit errors and Fit/Use are set by the engine
+  MplHitCache Hits;
+
+  // selected saturated strip hits of the whole event for the Hough
+  // finder, same preparation as Hits, no tracks
+  MplHitCache SatHits;
+
+  inline unsigned NTracks() const { return Pt.size(); }
+
+  void Clear();
+};
+
+// one combined track
+struct MplTrackSet {
+  enum Finder { kTrackFinder=0, kHoughFinder };
+
+  // kTrackFinder: tracks in Group, hits in MplTrackEvent::Hits
+  // kHoughFinder: Group empty, hits in MplTrackEvent::SatHits
+  int Finder;
+  std::vector<int> Group;
+  float XYPar[3], XYErr[3], RZPar[3], RZErr[3];
+  float Chi2XY, Chi2RZ;
+  int Ndof;
+  float Iso;
+  // by MplDeDxEstimator index, 0 if not selected
+  float DeDx[MplDeDxEstimator::kNEstimators];
+  int Hits, SatHits, SubHits, SatSubHits;
+};
+
+struct MplTrackerResult {
+  std::vector<MplTrackSet> Sets;
+
+  // hits of the tracks above the pt cut, only with TrackHitOutput
+  std::vector<int> HitTrack, HitStrips, HitSatStrips;
+  std::vector<float> HitX, HitY, HitZ, HitErrX, HitErrY, HitErrZ;
+
+  void Clear();
+};
+
+class MplTrackerWorkspace {
+  public:
+    MplTrackerWorkspace(const MplTrackerConfig &);
+    ~MplTrackerWorkspace();
+
+    std::vector<bool> Used;
+
+    // tracks above the pt cut that passed the saturation filter
+    std::vector<char> Seed;
+
+    // (phi, track index) of the seeds, sorted by phi
+    std::vector<std::pair<float,int> > PhiIndex;
+    std::vector<int> Candidates;
+
+    // eta-phi grid (bin offsets + track indices) for isolation
+    std::vector<int> IsoBinStart, IsoTracks, IsoBin, IsoFill;
+    std::vector<bool> InGroup;
+
+    // hit cache indices and running fit sums of the current group
+    std::vector<unsigned> Hits;
+    MplFitMoments Moments;
+    float SeedSlope;
+    MplGroupBuilder GroupBuilder;
+
+    // fit inputs in the fit frame, reused between fits
+    std::vector<double> FitX, FitY, FitEX, FitEY;
+    TF1 *RZFunc;
+    TF1 *XYFunc;
+
+    // charges of the current group for the dE/dx
+    MplDeDxEstimator DeDx;
+
+    // Hough candidates of the event and the saturated hits they claimed
+    MplHoughFinder Hough;
+    std::vector<MplHoughCandidate> HoughCandidates;
+    std::vector<std::pair<int,unsigned> > HoughOrder;
+    std::vector<char> HoughUsed;
+
+    // timing and agreement of the two fitters in validation mode
+    TStopwatch AnalyticWatch, RootWatch;
+    unsigned NEvents, NValidated;
+    float MaxDiffXY[3], MaxDiffRZ[3];
+
+    // pass rate and time of the saturation filter, time of the grouping
+    // and fits of the tracks after it
+    TStopwatch SatFilterWatch, GroupWatch;
+    unsigned NSatFilterTracks, NSatFilterPassed;
+
+    // time and yield of the Hough finder
+    TStopwatch HoughWatch;
+    unsigned NHoughHits, NHoughSets;
+
+  private:
+    MplTrackerWorkspace(const MplTrackerWorkspace &);
+    MplTrackerWorkspace & operator=(const MplTrackerWorkspace &);
+};
+
+class MplTrackEngine {
+  public:
+    MplTrackEngine(const MplTrackerConfig &);
+    ~MplTrackEngine();
+
+    inline const MplTrackerConfig & Config() const { return _Config; }
+
+    // set the fit errors and hit selection of the event hits from the config
+    void PrepareHits(MplHitCache &Hits) const;
+
+    // combine the tracks of one prepared event, W is only used by this call
+    void Process(const MplTrackEvent &Event, MplTrackerWorkspace &W, MplTrackerResult &Result) const;
+
+    // validation, saturation filter and Hough summary of a workspace,
+    // empty if none is enabled
+    std::string Summary(const MplTrackerWorkspace &W) const;
+
+  private:
+    MplTrackEngine(const MplTrackEngine &);
+    MplTrackEngine & operator=(const MplTrackEngine &);
+
+    void FillHitOutput(const MplTrackEvent &Event, MplTrackerResult &Result) const;
+    void SelectSeeds(const MplTrackEvent &Event, MplTrackerWorkspace &W) const;
+    void BuildPhiIndex(const MplTrackEvent &Event, MplTrackerWorkspace &W) const;
+    void FindPhiCandidates(const MplTrackerWorkspace &W, float Phi0, int Seed, std::vector<int> &Candidates) const;
+    void AddPhiRange(const MplTrackerWorkspace &W, float Lo, float Hi, int Seed, std::vector<int> &Candidates) const;
+    void BuildIsoGrid(const MplTrackEvent &Event, MplTrackerWorkspace &W) const;
+    int IsoEtaBin(float Eta) const;
+    int IsoPhiBin(float Phi) const;
+
+    int AddPoints(const MplTrackEvent &Event, MplTrackerWorkspace &W, unsigned iTrack) const;
+    void AddMoreTracks(const MplTrackEvent &Event, MplTrackerWorkspace &W, std::vector<int> &Group) const;
+    void ProcessHough(const MplTrackEvent &Event, MplTrackerWorkspace &W, MplTrackerResult &Result) const;
+    float GroupRadius(const MplTrackEvent &Event, const std::vector<int> &Group) const;
+    void FitXY(const MplHitCache &Hits, MplTrackerWorkspace &W, float Radius, MplTrackSet &Set) const;
+    void FitRZ(const MplHitCache &Hits, MplTrackerWorkspace &W, MplTrackSet &Set, bool Debug=false) const;
+    void RootFitXY(MplTrackerWorkspace &W, float Radius, MplFitResult &Res) const;
+    void RootFitRZ(MplTrackerWorkspace &W, MplFitResult &Res) const;
+    void CopyRootResult(const MplTrackerWorkspace &W, const TFitResultPtr &Result, MplFitResult &Res) const;
+    void SetXYResult(const MplFitResult &Res, float Phi0, MplTrackSet &Set) const;
+    void Validate(MplTrackerWorkspace &W, const MplFitResult &Analytic, const MplFitResult &Root, float *MaxDiff) const;
+    void AverageIso(const MplTrackEvent &Event, MplTrackerWorkspace &W, const std::vector<int> &Group,
+                    float InitEta, float InitPhi, MplTrackSet &Set) const;
+    void FitDeDx(const MplHitCache &Hits, MplTrackerWorkspace &W, MplTrackSet &Set) const;
+    void CountHits(const MplHitCache &Hits, const MplTrackerWorkspace &W, MplTrackSet &Set) const;
+
+    const MplTrackerConfig _Config;
+
+    // the one scheduler for Config.NThreads, NULL for one thread
+    tbb::task_scheduler_init *_Scheduler;
+};
+
+#endif
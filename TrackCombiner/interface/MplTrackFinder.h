@@ -0,0 +1,97 @@
+#ifndef Monopoles_MplTrackFinder_H
+#define Monopoles_MplTrackFinder_H
+
+//////////////////////////////////////////////////////////////
+// EDM side of the monopole track combination: fills the plain
+// MplTrackEvent of MplTrackEngine from the tracks, trajectories
+// and tracker geometry of an edm::Event, and with the Hough
+// finder enabled from the saturated strip rechits.
+//
+//  MplTrackerInput  handles, geometry table pointer and the converted
+//                   event, one per stream/thread
+//  MplTrackFinder   const converter + engine
+//
+// MplTracker, TrackCombinerReco and MplReplayDumper all use it.
+//////////////////////////////////////////////////////////////
+
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+#include "FWCore/Framework/interface/EventSetup.h"
+#include "FWCore/Framework/interface/Event.h"
+#include "DataFormats/Common/interface/Handle.h"
+
+#include "DataFormats/TrackReco/interface/Track.h"
+#include "DataFormats/TrackReco/interface/TrackFwd.h"
+#include "DataFormats/TrackingRecHit/interface/TrackingRecHit.h"
+#include "TrackingTools/PatternTools/interface/Trajectory.h"
+#include "TrackingTools/PatternTools/interface/TrajTrackAssociation.h"
+
+#include "Monopoles/MonoAlgorithms/interface/MonoTrackerGeomTable.h"
+#include "Monopoles/MonoAlgorithms/interface/MonoStripAmplitudes.h"
+#include "Monopoles/TrackCombiner/interface/MplTrackEngine.h"
+
+#include <TStopwatch.h>
+
+#include <vector>
+#include <string>
+
+class MplTrackerInput {
+  public:
+    MplTrackerInput(const MplTrackerConfig &);
+
+    edm::Handle<reco::TrackCollection> hTracks;
+    edm::Handle<std::vector<Trajectory> > hTrajectories;
+    edm::Handle<TrajTrackAssociationCollection> hTrajTrackAssociations;
+
+    // per DetId norm factor and surface frame, the job-wide table of the
+    // event's geometry set by Fill and held until the next event
+    Mono::MonoTrackerGeomTable::SharedPtr GeomTable;
+
+    // track index -> trajectory, NULL without trajectories in the event
+    std::vector<const Trajectory *> TrajIndex;
+
+    MplTrackEvent Event;
+
+    // valid hits of the current track, their module index and cluster,
+    // read before the geometry so the saturation filter can skip it
+    std::vector<const TrackingRecHit *> TrackHits;
+    std::vector<int> TrackDets;
+    std::vector<Mono::StripAmplitudes> TrackAmpls;
+
+    // time of the geometry transforms of the filled hits, and the tracks
+    // and hits the saturation filter skipped before them
+    TStopwatch TransformWatch;
+    unsigned NEvents, NFilledHits;
+    unsigned NPreFilterTracks, NPreFilterSkipped, NSkippedHits;
+
+  private:
+    MplTrackerInput(const MplTrackerInput &);
+    MplTrackerInput & operator=(const MplTrackerInput &);
+};
+
+class MplTrackFinder {
+  public:
+    MplTrackFinder(const edm::ParameterSet &, const std::string &Prefix="Track");
+
+    inline const MplTrackerConfig & Config() const { return _Engine.Config(); }
+    inline const MplTrackEngine & Engine() const { return _Engine; }
+
+    // convert one event into In.Event, with the hits prepared for the engine
+    void Fill(const edm::Event &, const edm::EventSetup &, MplTrackerInput &In) const;
+
+    // Fill and combine the tracks of one event
+    void Process(const edm::Event &, const edm::EventSetup &, MplTrackerInput &In,
+                 MplTrackerWorkspace &W, MplTrackerResult &Result) const;
+
+    // validation summary of a workspace and the saturation pre-filter
+    // savings of an input to the message logger, for endJob
+    void Summary(const MplTrackerWorkspace &W, const MplTrackerInput &In) const;
+
+  private:
+    void BuildTrajIndex(MplTrackerInput &In) const;
+    void FillHitCache(MplTrackerInput &In) const;
+    void FillSatHits(const edm::Event &, MplTrackerInput &In) const;
+
+    const MplTrackEngine _Engine;
+};
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef Monopoles_MplTrackRecord_H
+#define Monopoles_MplTrackRecord_H
+
+//////////////////////////////////////////////////////////////
+// One combined track (MplTrackSet) as written by MplTracker:
+// a vector of these is a single split branch, "Track", where
+// each field becomes a leaf "Track.XYPar[3]" etc. in its own
+// basket.  The tracks of a set are the jagged range
+// [GroupBegin, GroupBegin+GroupSize) of the flat "Track_Group"
+// branch.  Fixed-width only, so the dictionary is trivial and
+// a reader needs no more than the one header.
+//////////////////////////////////////////////////////////////
+
+#include "Monopoles/TrackCombiner/interface/MplDeDx.h"
+
+struct MplTrackSet;
+
+enum EcalClustID {
+  fEBClean=0,
+  fEBUnclean,
+  fEBCombined,
+  fEEClean,
+  fEEUnclean,
+  fEECombined,
+  fNEcalClustID
+};
+
+struct MplTrackRecord {
+  MplTrackRecord();
+
+  // all but the cluster matches, which MplTracker::doMatch fills later
+  void Fill(const MplTrackSet &Set, int Begin);
+
+  // MplTrackSet::Finder: 0 combined tracks, 1 Hough candidate
+  int Finder;
+  int GroupBegin, GroupSize;
+
+  float XYPar[3], XYErr[3], RZPar[3], RZErr[3];
+  float Chi2XY, Chi2RZ;
+  int Ndof;
+  float Iso;
+  int Hits, SatHits, SubHits, SatSubHits;
+
+  // by MplDeDxEstimator index, 0 if not in DeDxMask
+  float DeDx[MplDeDxEstimator::kNEstimators];
+
+  // by EcalClustID: cluster index (-1 none) and distance (999 none)
+  int ClustMatch[fNEcalClustID];
+  float ClustDist[fNEcalClustID];
+};
+
+#endif
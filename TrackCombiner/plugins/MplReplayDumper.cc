@@ -0,0 +1,45 @@
+#include "Monopoles/TrackCombiner/interface/MplReplayDumper.h"
+
+#include "FWCore/Framework/interface/Event.h"
+#include "FWCore/Framework/interface/EventSetup.h"
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+#include "FWCore/MessageLogger/interface/MessageLogger.h"
+#include "FWCore/Utilities/interface/Exception.h"
+
+using namespace std; using namespace edm;
+
+/// Constructor
+MplReplayDumper::MplReplayDumper(const ParameterSet& parameterSet) :
+  _Finder(parameterSet), _Writer(0)
+{
+  _FileName = parameterSet.getUntrackedParameter<std::string>("ReplayFile", "MplReplay.bin");
+  _Input = new MplTrackerInput(_Finder.Config());
+}
+ 
+
+/// Destructor
+MplReplayDumper::~MplReplayDumper(){
+  delete _Input;
+  delete _Writer;
+}
+
+void MplReplayDumper::beginJob(){
+  _Writer = new MplReplayWriter(_FileName);
+  if(!_Writer->Good())
+    throw cms::Exception("MplReplayDumper") << "Cannot open " << _FileName << " for writing.";
+}
+
+void MplReplayDumper::endJob(){
+  if(!_Writer->Good())
+    edm::LogError("MplReplayDumper") << "Write error on " << _FileName << " after " << _Writer->NEvents() << " events.";
+  else
+    edm::LogInfo("MplReplayDumper") << _Writer->NEvents() << " events written to " << _FileName;
+
+  delete _Writer;
+  _Writer = 0;
+}
+
+void MplReplayDumper::analyze(const Event& event, const EventSetup& setup){
+  _Finder.Fill(event, setup, *_Input);
+  _Writer->Write(_Input->Event);
+}
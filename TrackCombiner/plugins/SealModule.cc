@@ -3,6 +3,8 @@
 #include "FWCore/Framework/interface/MakerMacros.h"
 
 #include "Monopoles/TrackCombiner/interface/TrackCombinerReco.h"
+#include "Monopoles/TrackCombiner/interface/MplReplayDumper.h"
 
 
 DEFINE_FWK_MODULE(TrackCombinerReco);
+DEFINE_FWK_MODULE(MplReplayDumper);
@@ -0,0 +1,121 @@
+#include "Monopoles/TrackCombiner/interface/MplDeDx.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+  const char *Names[MplDeDxEstimator::kNEstimators] = {"Median", "TruncatedMean", "Harmonic2", "LandauMPV"};
+
+  // golden section search of the Moyal width
+  const int WidthIterations = 40;
+  const double Golden = 0.381966011250105;
+
+  // profile log likelihood of the Moyal density at width Sigma: for a
+  // fixed width the MPV has the closed form
+  //   MPV = Min + Sigma*log(n / sum exp(-(q-Min)/Sigma))
+  double MoyalProfile(const std::vector<float> &q, double Min, double Sigma, double &MPV){
+    const unsigned n = q.size();
+    double S = 0, Sum = 0;
+    for(unsigned i=0; i<n; i++){
+      S += exp(-(q[i]-Min)/Sigma);
+      Sum += q[i];
+    }
+    MPV = Min + Sigma*log(n/S);
+
+    // sum exp(-lambda) = n at the MPV above
+    return -0.5*(Sum - n*MPV)/Sigma - 0.5*n - n*log(Sigma);
+  }
+}
+
+const char * MplDeDxEstimator::Name(int Estimator){
+  return Estimator >= 0 && Estimator < kNEstimators ? Names[Estimator] : "";
+}
+
+int MplDeDxEstimator::Find(const std::string &Name){
+  for(int i=0; i<kNEstimators; i++)
+    if(Name == Names[i]) return i;
+  return -1;
+}
+
+MplDeDxEstimator::MplDeDxEstimator(float Truncation) :
+  _Truncation(Truncation)
+{
+  _Charges.reserve(64);
+}
+
+void MplDeDxEstimator::Compute(unsigned Mask, float *Values){
+  if(Mask & (1 << kLandauMPV)) Values[kLandauMPV] = LandauMPV();
+  if(Mask & (1 << kHarmonic2)) Values[kHarmonic2] = Harmonic2();
+  if(Mask & (1 << kMedian)) Values[kMedian] = Median();
+  if(Mask & (1 << kTruncatedMean)) Values[kTruncatedMean] = TruncatedMean();
+}
+
+float MplDeDxEstimator::Median(){
+  if(_Charges.empty()) return 0;
+
+  std::vector<float>::iterator Mid = _Charges.begin() + _Charges.size()/2;
+  std::nth_element(_Charges.begin(), Mid, _Charges.end());
+  return *Mid;
+}
+
+float MplDeDxEstimator::TruncatedMean(){
+  const unsigned n = _Charges.size();
+  if(n == 0) return 0;
+
+  // keep at least one charge
+  unsigned Keep = (unsigned)(n*(1 - _Truncation) + 0.5);
+  if(Keep < 1) Keep = 1;
+  if(Keep > n) Keep = n;
+
+  // the Keep lowest charges end up in front, in any order
+  if(Keep < n) std::nth_element(_Charges.begin(), _Charges.begin() + Keep, _Charges.end());
+
+  double Sum = 0;
+  for(unsigned i=0; i<Keep; i++) Sum += _Charges[i];
+  return Sum/Keep;
+}
+
+float MplDeDxEstimator::Harmonic2() const {
+  const unsigned n = _Charges.size();
+  if(n == 0) return 0;
+
+  double Sum = 0;
+  for(unsigned i=0; i<n; i++) Sum += 1./(_Charges[i]*_Charges[i]);
+  return 1./sqrt(Sum/n);
+}
+
+float MplDeDxEstimator::LandauMPV() const {
+  const unsigned n = _Charges.size();
+  if(n == 0) return 0;
+
+  double Min = _Charges[0], Max = _Charges[0];
+  for(unsigned i=1; i<n; i++){
+    Min = std::min(Min, (double)_Charges[i]);
+    Max = std::max(Max, (double)_Charges[i]);
+  }
+  if(n < 3 || Max <= Min) return Min;
+
+  // maximise the profile likelihood in log(width), between a width much
+  // smaller than the spread of the charges and one as large as the spread
+  double a = log((Max-Min)*1e-3), b = log(Max-Min);
+  double x1 = a + Golden*(b-a), x2 = b - Golden*(b-a);
+  double MPV1, MPV2;
+  double L1 = MoyalProfile(_Charges, Min, exp(x1), MPV1);
+  double L2 = MoyalProfile(_Charges, Min, exp(x2), MPV2);
+
+  for(int i=0; i<WidthIterations; i++){
+    if(L1 > L2){
+      b = x2;
+      x2 = x1; L2 = L1; MPV2 = MPV1;
+      x1 = a + Golden*(b-a);
+      L1 = MoyalProfile(_Charges, Min, exp(x1), MPV1);
+    }else{
+      a = x1;
+      x1 = x2; L1 = L2; MPV1 = MPV2;
+      x2 = b - Golden*(b-a);
+      L2 = MoyalProfile(_Charges, Min, exp(x2), MPV2);
+    }
+  }
+
+  return L1 > L2 ? MPV1 : MPV2;
+}
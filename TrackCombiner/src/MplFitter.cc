@@ -0,0 +1,323 @@
+#include "Monopoles/TrackCombiner/interface/MplFitter.h"
+
+#include <cmath>
+
+void MplFitResult::Reset(int n){
+  for(int i=0; i<3; i++){
+    Par[i] = 0;
+    Err[i] = 0;
+    for(int j=0; j<3; j++) Cov[i][j] = 0;
+  }
+  Chi2 = 0;
+  Ndof = n - 3;
+  Valid = false;
+}
+
+bool MplFit::Invert3(const double M[3][3], double Inv[3][3]){
+  const double c00 = M[1][1]*M[2][2] - M[1][2]*M[2][1];
+  const double c01 = M[1][2]*M[2][0] - M[1][0]*M[2][2];
+  const double c02 = M[1][0]*M[2][1] - M[1][1]*M[2][0];
+
+  const double Det = M[0][0]*c00 + M[0][1]*c01 + M[0][2]*c02;
+
+  // relative test so that the scale of the moments does not matter
+  const double Scale = fabs(M[0][0]*M[1][1]*M[2][2]);
+  if(Det == 0 || fabs(Det) <= 1e-14*Scale) return false;
+
+  Inv[0][0] = c00/Det;
+  Inv[1][0] = c01/Det;
+  Inv[2][0] = c02/Det;
+  Inv[0][1] = (M[0][2]*M[2][1] - M[0][1]*M[2][2])/Det;
+  Inv[1][1] = (M[0][0]*M[2][2] - M[0][2]*M[2][0])/Det;
+  Inv[2][1] = (M[0][1]*M[2][0] - M[0][0]*M[2][1])/Det;
+  Inv[0][2] = (M[0][1]*M[1][2] - M[0][2]*M[1][1])/Det;
+  Inv[1][2] = (M[0][2]*M[1][0] - M[0][0]*M[1][2])/Det;
+  Inv[2][2] = (M[0][0]*M[1][1] - M[0][1]*M[1][0])/Det;
+
+  return true;
+}
+
+void MplFit::FitParabola(unsigned n, const double *r, const double *z,
+                         const double *er, const double *ez, MplFitResult &Res){
+  Res.Reset(n);
+  if(n < 3) return;
+
+  // work in r/RScale to keep the normal matrix well conditioned
+  double RScale = 0;
+  for(unsigned i=0; i<n; i++) if(fabs(r[i]) > RScale) RScale = fabs(r[i]);
+  if(RScale <= 0) return;
+
+  double q[3] = {0, 0, 0}, C[3][3];
+
+  // pass 0 uses the z errors only, pass 1 adds the r errors through the slope
+  for(int Pass=0; Pass<2; Pass++){
+    double S[5] = {0, 0, 0, 0, 0}, T[3] = {0, 0, 0};
+
+    for(unsigned i=0; i<n; i++){
+      const double u = r[i]/RScale;
+      const double Slope = (q[1] + 2*q[2]*u)/RScale;
+      const double Var = ez[i]*ez[i] + (Pass ? Slope*Slope*er[i]*er[i] : 0);
+      if(Var <= 0) continue;
+
+      const double w = 1/Var;
+      double uk = w;
+      for(int k=0; k<5; k++){
+        S[k] += uk;
+        if(k < 3) T[k] += uk*z[i];
+        uk *= u;
+      }
+    }
+
+    const double M[3][3] = { {S[0], S[1], S[2]}, {S[1], S[2], S[3]}, {S[2], S[3], S[4]} };
+    if(!Invert3(M, C)) return;
+
+    for(int k=0; k<3; k++) q[k] = C[k][0]*T[0] + C[k][1]*T[1] + C[k][2]*T[2];
+  }
+
+  double Chi2 = 0;
+  for(unsigned i=0; i<n; i++){
+    const double u = r[i]/RScale;
+    const double Slope = (q[1] + 2*q[2]*u)/RScale;
+    const double Var = ez[i]*ez[i] + Slope*Slope*er[i]*er[i];
+    if(Var <= 0) continue;
+
+    const double Resid = z[i] - (q[0] + q[1]*u + q[2]*u*u);
+    Chi2 += Resid*Resid/Var;
+  }
+
+  const double Scale[3] = {1, 1/RScale, 1/(RScale*RScale)};
+  for(int i=0; i<3; i++){
+    Res.Par[i] = q[i]*Scale[i];
+    for(int j=0; j<3; j++) Res.Cov[i][j] = C[i][j]*Scale[i]*Scale[j];
+    Res.Err[i] = sqrt(Res.Cov[i][i]);
+  }
+  Res.Chi2 = Chi2;
+  Res.Valid = true;
+}
+
+void MplFit::FitCircle(unsigned n, const double *x, const double *y,
+                       const double *ex, const double *ey, MplFitResult &Res){
+  Res.Reset(n);
+  if(n < 3) return;
+
+  // weighted centroid as the reference point of the fit
+  double Sw = 0, Xm = 0, Ym = 0;
+  for(unsigned i=0; i<n; i++){
+    const double Var = ex[i]*ex[i] + ey[i]*ey[i];
+    if(Var <= 0) continue;
+    const double w = 2/Var;
+    Sw += w;
+    Xm += w*x[i];
+    Ym += w*y[i];
+  }
+  if(Sw <= 0) return;
+  Xm /= Sw;
+  Ym /= Sw;
+
+  // Karimaki: direction Phi, curvature Kappa and signed distance D at the
+  // centroid from the weighted moments, all finite for a straight line
+  double Cuu=0, Cuv=0, Cvv=0, Cuq=0, Cvq=0, Qm=0, Cqq=0;
+  for(unsigned i=0; i<n; i++){
+    const double Var = ex[i]*ex[i] + ey[i]*ey[i];
+    if(Var <= 0) continue;
+    const double w = 2/Var;
+    const double u = x[i] - Xm, v = y[i] - Ym, q = u*u + v*v;
+    Cuu += w*u*u; Cuv += w*u*v; Cvv += w*v*v;
+    Cuq += w*u*q; Cvq += w*v*q;
+    Qm += w*q; Cqq += w*q*q;
+  }
+  Cuu /= Sw; Cuv /= Sw; Cvv /= Sw; Cuq /= Sw; Cvq /= Sw; Qm /= Sw;
+  Cqq = Cqq/Sw - Qm*Qm;
+  if(Cqq <= 0) return;
+
+  double Phi = 0.5*atan2(2*(Cqq*Cuv - Cuq*Cvq), Cqq*(Cuu - Cvv) - Cuq*Cuq + Cvq*Cvq);
+  // pointing away from the origin
+  if(cos(Phi)*Xm + sin(Phi)*Ym < 0) Phi += M_PI;
+
+  double Kappa = 2*(cos(Phi)*Cvq - sin(Phi)*Cuq)/Cqq;
+  double D = -Kappa*Qm/2;
+
+  // one Gauss-Newton step on the geometric distances in (Kappa, Phi, D),
+  // then the covariance and chi2 are evaluated at the refined parameters.
+  // With g = Kappa/2 p^2 - (1+Kappa D) p.n + Kappa D^2/2 + D, n the left
+  // normal, the distance is 2g/(1+sqrt(1+2 Kappa g)), g itself for a line.
+  double A[3][3], C[3][3];
+  for(int Step=0; Step<2; Step++){
+    const double CosPhi = cos(Phi), SinPhi = sin(Phi);
+    double G[3] = {0, 0, 0}, Chi2 = 0;
+    for(int j=0; j<3; j++) for(int k=0; k<3; k++) A[j][k] = 0;
+
+    for(unsigned i=0; i<n; i++){
+      const double u = x[i] - Xm, v = y[i] - Ym;
+      const double Pn = v*CosPhi - u*SinPhi, Pt = u*CosPhi + v*SinPhi;
+      const double g = Kappa*(u*u + v*v)/2 - (1 + Kappa*D)*Pn + Kappa*D*D/2 + D;
+
+      const double S2 = 1 + 2*Kappa*g;
+      if(S2 <= 0) continue;
+      const double S = sqrt(S2);
+
+      // error along the normal of the circle at the hit
+      const double Gx = Kappa*u + (1 + Kappa*D)*SinPhi, Gy = Kappa*v - (1 + Kappa*D)*CosPhi;
+      const double G2 = Gx*Gx + Gy*Gy;
+      if(G2 <= 0) continue;
+      const double Var = (Gx*Gx*ex[i]*ex[i] + Gy*Gy*ey[i]*ey[i])/G2;
+      if(Var <= 0) continue;
+
+      const double w = 1/Var;
+      const double d = 2*g/(1 + S);
+      const double DdG = 2/(1 + S) - 2*g*Kappa/(S*(1 + S)*(1 + S));
+      const double DdKappa = -2*g*g/(S*(1 + S)*(1 + S));
+      const double J[3] = { DdG*((u*u + v*v)/2 - D*Pn + D*D/2) + DdKappa,
+                            DdG*(1 + Kappa*D)*Pt,
+                            DdG*(1 + Kappa*D - Kappa*Pn) };
+
+      for(int j=0; j<3; j++){
+        G[j] += w*J[j]*d;
+        for(int k=0; k<3; k++) A[j][k] += w*J[j]*J[k];
+      }
+      Chi2 += w*d*d;
+    }
+
+    if(!Invert3(A, C)) return;
+
+    if(Step == 1){
+      Res.Chi2 = Chi2;
+      break;
+    }
+
+    Kappa -= C[0][0]*G[0] + C[0][1]*G[1] + C[0][2]*G[2];
+    Phi -= C[1][0]*G[0] + C[1][1]*G[1] + C[1][2]*G[2];
+    D -= C[2][0]*G[0] + C[2][1]*G[1] + C[2][2]*G[2];
+  }
+
+  // a straight track gets the largest radius, on the side it bends to
+  if(fabs(Kappa) < 1/MaxRadius) Kappa = Kappa < 0 ? -1/MaxRadius : 1/MaxRadius;
+
+  const double CosPhi = cos(Phi), SinPhi = sin(Phi);
+  const double Q = D + 1/Kappa;
+  const double a = Xm - Q*SinPhi, b = Ym + Q*CosPhi;
+
+  // branch of the semicircle the points lie on
+  double SumDy = 0;
+  for(unsigned i=0; i<n; i++) SumDy += y[i] - b;
+  const double Sign = SumDy >= 0 ? 1 : -1;
+
+  Res.Par[0] = b + Sign/fabs(Kappa);
+  Res.Par[1] = a;
+  Res.Par[2] = Sign/fabs(Kappa);
+
+  // (Kappa, Phi, D) -> (p0, p1, p2)
+  const double K2 = Kappa*Kappa;
+  const double DR = -Sign*(Kappa < 0 ? -1 : 1)/K2;
+  const double T[3][3] = { {-CosPhi/K2 + DR, -Q*SinPhi, CosPhi},
+                           {SinPhi/K2, -Q*CosPhi, -SinPhi},
+                           {DR, 0, 0} };
+  for(int i=0; i<3; i++){
+    for(int j=0; j<3; j++){
+      double Sum = 0;
+      for(int k=0; k<3; k++)
+        for(int l=0; l<3; l++) Sum += T[i][k]*C[k][l]*T[j][l];
+      Res.Cov[i][j] = Sum;
+    }
+    Res.Err[i] = sqrt(Res.Cov[i][i]);
+  }
+  Res.Valid = true;
+}
+
+const double MplFitMoments::RScale = 100.;
+
+void MplFitMoments::Reset(){
+  for(int k=0; k<5; k++) SR[k] = 0;
+  for(int k=0; k<3; k++) SZR[k] = 0;
+  SZZ = 0;
+  X0 = Y0 = Sin0 = 0;
+  Cos0 = 1;
+  Sw = Su = Sv = Suu = Suv = Svv = Sq = Squ = Sqv = Sqq = 0;
+  N = 0;
+}
+
+void MplFitMoments::Add(double x, double y, double wxy, double z, double wz){
+  const double r = sqrt(x*x + y*y);
+  const double u = r/RScale;
+
+  double uk = wz;
+  for(int k=0; k<5; k++){
+    SR[k] += uk;
+    if(k < 3) SZR[k] += uk*z;
+    uk *= u;
+  }
+  SZZ += wz*z*z;
+
+  // the first hit fixes the XY frame, so the sums do not grow with the
+  // distance from the beam and a straight track stays a straight line
+  if(N == 0){
+    X0 = x;
+    Y0 = y;
+    if(r > 0){
+      Cos0 = x/r;
+      Sin0 = y/r;
+    }
+  }
+
+  const double Dx = (x - X0)/RScale, Dy = (y - Y0)/RScale;
+  const double Pu = Dx*Cos0 + Dy*Sin0, Pv = Dy*Cos0 - Dx*Sin0, q = Pu*Pu + Pv*Pv;
+
+  Sw += wxy;
+  Su += wxy*Pu;
+  Sv += wxy*Pv;
+  Suu += wxy*Pu*Pu;
+  Suv += wxy*Pu*Pv;
+  Svv += wxy*Pv*Pv;
+  Sq += wxy*q;
+  Squ += wxy*q*Pu;
+  Sqv += wxy*q*Pv;
+  Sqq += wxy*q*q;
+
+  N++;
+}
+
+double MplFitMoments::Chi2RZ() const {
+  if(N < 3) return 0;
+
+  const double M[3][3] = { {SR[0], SR[1], SR[2]}, {SR[1], SR[2], SR[3]}, {SR[2], SR[3], SR[4]} };
+  double C[3][3];
+  if(!MplFit::Invert3(M, C)) return 0;
+
+  // at the minimum chi2 = sum w z^2 - p.T
+  double Chi2 = SZZ;
+  for(int k=0; k<3; k++)
+    Chi2 -= (C[k][0]*SZR[0] + C[k][1]*SZR[1] + C[k][2]*SZR[2]) * SZR[k];
+
+  return Chi2 > 0 ? Chi2 : 0;
+}
+
+double MplFitMoments::Chi2XY() const {
+  if(N < 3) return 0;
+
+  // v = a q + b u + c: a circle through the hits, a line for a = 0.  The
+  // algebraic residual is the distance times the gradient norm, which is
+  // sqrt(1 + b^2) at the first hit and changes by u/R along the track.
+  double Chi2, Slope = 0;
+  const double K[3][3] = { {Sqq, Squ, Sq}, {Squ, Suu, Su}, {Sq, Su, Sw} };
+  double KInv[3][3];
+  if(MplFit::Invert3(K, KInv)){
+    const double T[3] = {Sqv, Suv, Sv};
+    Chi2 = Svv;
+    for(int k=0; k<3; k++)
+      Chi2 -= (KInv[k][0]*T[0] + KInv[k][1]*T[1] + KInv[k][2]*T[2]) * T[k];
+    Slope = KInv[1][0]*T[0] + KInv[1][1]*T[1] + KInv[1][2]*T[2];
+  }else{
+    // no spread in q beyond that in u: the best line, or the mean of v
+    // when all the hits are at one u
+    const double Det = Suu*Sw - Su*Su;
+    if(Det > 1e-14*Suu*Sw){
+      Slope = (Sw*Suv - Su*Sv)/Det;
+      Chi2 = Svv - Slope*Suv - (Suu*Sv - Su*Suv)/Det*Sv;
+    }else{
+      Chi2 = Sw > 0 ? Svv - Sv*Sv/Sw : 0;
+    }
+  }
+
+  Chi2 *= RScale*RScale/(1 + Slope*Slope);
+  return Chi2 > 0 ? Chi2 : 0;
+}
@@ -0,0 +1,131 @@
+#include "Monopoles/TrackCombiner/interface/MplGroupBuilder.h"
+
+#include "tbb/parallel_for.h"
+#include "tbb/blocked_range.h"
+
+#include <algorithm>
+
+using std::min;
+
+MplGroupBuilder::MplGroupBuilder(float Chi2Cut, int NThreads) :
+  _Chi2Cut(Chi2Cut), _NThreads(NThreads > 1 ? NThreads : 1)
+{
+}
+
+int MplGroupBuilder::AddTrackHits(const MplHitCache &Cache, unsigned iTrack, float SeedSlope,
+                                  MplFitMoments &Moments, std::vector<unsigned> *Hits){
+  int NPoints = 0;
+
+  for(unsigned h=Cache.Begin(iTrack); h<Cache.End(iTrack); h++){
+    if(!Cache.Fit[h]) continue;
+
+    if(Hits) Hits->push_back(h);
+
+    Moments.Add(Cache.X[h], Cache.Y[h], 2/(Cache.FitCxx[h] + Cache.FitCyy[h]),
+                Cache.Z[h], 1/(Cache.FitCzz[h] + SeedSlope*SeedSlope*Cache.FitRErr2(h)));
+
+    if(Cache.Use[h]) NPoints++;
+  }
+
+  return NPoints;
+}
+
+bool MplGroupBuilder::Accept(const MplFitMoments &Moments) const {
+  int Ndof = Moments.Ndof();
+  return !(Ndof > 0 && (Moments.Chi2XY() / Ndof > _Chi2Cut || Moments.Chi2RZ() / Ndof > _Chi2Cut));
+}
+
+void MplGroupBuilder::AddCandidates(const MplHitCache &Cache, const std::vector<int> &Candidates,
+                                    const std::vector<bool> &Used, float SeedSlope,
+                                    MplFitMoments &Moments, std::vector<unsigned> &Hits,
+                                    std::vector<int> &Group){
+  if(_NThreads > 1 && Candidates.size() > 1)
+    AddParallel(Cache, Candidates, Used, SeedSlope, Moments, Hits, Group);
+  else
+    AddSerial(Cache, Candidates, Used, SeedSlope, Moments, Hits, Group);
+}
+
+void MplGroupBuilder::AddSerial(const MplHitCache &Cache, const std::vector<int> &Candidates,
+                                const std::vector<bool> &Used, float SeedSlope,
+                                MplFitMoments &Moments, std::vector<unsigned> &Hits,
+                                std::vector<int> &Group) const {
+  for(unsigned c=0; c<Candidates.size(); c++){
+    const int i = Candidates[c];
+    if(Used[i]) continue;
+
+    const MplFitMoments Before = Moments;
+    const unsigned NHits = Hits.size();
+
+    if(AddTrackHits(Cache, i, SeedSlope, Moments, &Hits) == 0 || !Accept(Moments)){
+      Moments = Before;
+      Hits.resize(NHits);
+      continue;
+    }
+
+    Group.push_back(i);
+  }
+}
+
+namespace {
+  // tests candidates [Begin, End) against a fixed group, one copy of the
+  // sums per candidate so the tasks share nothing but read-only input
+  class EvaluateCandidates {
+    public:
+      EvaluateCandidates(const MplGroupBuilder &Builder, const MplHitCache &Cache,
+                         const std::vector<int> &Candidates, const std::vector<bool> &Used,
+                         float SeedSlope, const MplFitMoments &Moments, std::vector<char> &Accepted) :
+        _Builder(Builder), _Cache(Cache), _Candidates(Candidates), _Used(Used),
+        _SeedSlope(SeedSlope), _Moments(Moments), _Accepted(Accepted) {}
+
+      void operator()(const tbb::blocked_range<unsigned> &Range) const {
+        for(unsigned c=Range.begin(); c!=Range.end(); c++){
+          const int i = _Candidates[c];
+          _Accepted[c] = 0;
+          if(_Used[i]) continue;
+
+          MplFitMoments Trial = _Moments;
+          if(MplGroupBuilder::AddTrackHits(_Cache, i, _SeedSlope, Trial) == 0) continue;
+          _Accepted[c] = _Builder.Accept(Trial);
+        }
+      }
+
+    private:
+      const MplGroupBuilder &_Builder;
+      const MplHitCache &_Cache;
+      const std::vector<int> &_Candidates;
+      const std::vector<bool> &_Used;
+      float _SeedSlope;
+      const MplFitMoments &_Moments;
+      std::vector<char> &_Accepted;
+  };
+}
+
+void MplGroupBuilder::AddParallel(const MplHitCache &Cache, const std::vector<int> &Candidates,
+                                  const std::vector<bool> &Used, float SeedSlope,
+                                  MplFitMoments &Moments, std::vector<unsigned> &Hits,
+                                  std::vector<int> &Group){
+  const unsigned NCandidates = Candidates.size();
+  const unsigned Batch = BatchPerThread*_NThreads;
+  _Accepted.resize(NCandidates);
+
+  unsigned Next = 0;
+  while(Next < NCandidates){
+    // every candidate before the first accepted one is rejected by the
+    // serial algorithm too, since it sees the same group; the ones after
+    // it are tested again, so only a batch is tested per round
+    const unsigned End = min(NCandidates, Next + Batch);
+    tbb::parallel_for(tbb::blocked_range<unsigned>(Next, End),
+                      EvaluateCandidates(*this, Cache, Candidates, Used, SeedSlope, Moments, _Accepted));
+
+    unsigned c = Next;
+    while(c < End && !_Accepted[c]) c++;
+    if(c == End){
+      Next = End;
+      continue;
+    }
+
+    AddTrackHits(Cache, Candidates[c], SeedSlope, Moments, &Hits);
+    Group.push_back(Candidates[c]);
+    Next = c+1;
+  }
+}
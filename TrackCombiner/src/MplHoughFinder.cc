@@ -0,0 +1,341 @@
+#include "Monopoles/TrackCombiner/interface/MplHoughFinder.h"
+
+#include "tbb/parallel_for.h"
+#include "tbb/blocked_range.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+namespace {
+  inline int Wrap(int Bin, int N){
+    Bin %= N;
+    return Bin < 0 ? Bin + N : Bin;
+  }
+
+  inline float DeltaPhi(float a, float b){
+    float d = a - b;
+    while(d > M_PI) d -= 2*M_PI;
+    while(d <= -M_PI) d += 2*M_PI;
+    return d;
+  }
+
+  // z residual to the fitted parabola over its error, the r error through the slope
+  inline double PullRZ(const MplFitResult &Res, double r, double z, double er, double ez){
+    const double Slope = Res.Par[1] + 2*Res.Par[2]*r;
+    const double Var = ez*ez + Slope*Slope*er*er;
+    return Var > 0 ? fabs(z - (Res.Par[0] + Res.Par[1]*r + Res.Par[2]*r*r))/sqrt(Var) : 0;
+  }
+
+  // sectors [Begin, End), each task writes only to its own sector
+  class FindSectors {
+    public:
+      FindSectors(const MplHoughFinder &Finder, const MplHitCache &Hits, vector<MplHoughSector> &Sectors) :
+        _Finder(Finder), _Hits(Hits), _Sectors(Sectors) {}
+
+      void operator()(const tbb::blocked_range<unsigned> &Range) const {
+        for(unsigned s=Range.begin(); s!=Range.end(); s++) _Finder.FindSector(_Hits, _Sectors[s]);
+      }
+
+    private:
+      const MplHoughFinder &_Finder;
+      const MplHitCache &_Hits;
+      vector<MplHoughSector> &_Sectors;
+  };
+}
+
+MplHoughConfig::MplHoughConfig() :
+  Enable(false), SatFraction(0.5), MinSatStrips(2), MinHits(6),
+  NSectors(16), NPhi(256), NCurv(32), MaxCurv(0.005),
+  NZ0(8), NRZCurv(16), NSlope(64), MaxZ0(15), MaxRZCurv(0.005),
+  PullCut(3)
+{
+  Sources.push_back("siStripMatchedRecHits:rphiRecHit");
+  Sources.push_back("siStripMatchedRecHits:stereoRecHit");
+}
+
+MplHoughFinder::MplHoughFinder(const MplHoughConfig &Config, int NThreads) :
+  _Config(Config), _NThreads(NThreads > 1 ? NThreads : 1), _Halo(0)
+{
+  _PhiWidth = 2*M_PI/_Config.NPhi;
+  _CurvWidth = 2*_Config.MaxCurv/_Config.NCurv;
+  _Z0Width = 2*_Config.MaxZ0/_Config.NZ0;
+  _RZCurvWidth = 2*_Config.MaxRZCurv/_Config.NRZCurv;
+  _AngleWidth = M_PI/_Config.NSlope;
+
+  const int NSectors = max(1, min(_Config.NSectors, _Config.NPhi));
+  _Sectors.resize(NSectors);
+  for(int s=0; s<NSectors; s++){
+    _Sectors[s].Begin = s*_Config.NPhi/NSectors;
+    _Sectors[s].End = (s+1)*_Config.NPhi/NSectors;
+  }
+}
+
+inline int MplHoughFinder::PhiBin(float Phi) const {
+  return Wrap((int)floor((Phi + M_PI)/_PhiWidth), _Config.NPhi);
+}
+
+inline float MplHoughFinder::PhiCentre(int Bin) const {
+  return -M_PI + (Bin + 0.5)*_PhiWidth;
+}
+
+inline float MplHoughFinder::CurvCentre(int Bin) const {
+  return -_Config.MaxCurv + (Bin + 0.5)*_CurvWidth;
+}
+
+void MplHoughFinder::Find(const MplHitCache &Hits, vector<MplHoughCandidate> &Candidates){
+  Candidates.clear();
+  if(Hits.NHits() == 0) return;
+
+  BinHits(Hits);
+
+  if(_NThreads > 1 && _Sectors.size() > 1)
+    tbb::parallel_for(tbb::blocked_range<unsigned>(0, _Sectors.size()), FindSectors(*this, Hits, _Sectors));
+  else
+    for(unsigned s=0; s<_Sectors.size(); s++) FindSector(Hits, _Sectors[s]);
+
+  // sector order is Phi0 order, whatever the number of threads
+  for(unsigned s=0; s<_Sectors.size(); s++)
+    Candidates.insert(Candidates.end(), _Sectors[s].Candidates.begin(), _Sectors[s].Candidates.end());
+}
+
+void MplHoughFinder::BinHits(const MplHitCache &Hits){
+  const unsigned NHits = Hits.NHits();
+  const int NPhi = _Config.NPhi;
+
+  _Phi.resize(NHits);
+  _R.resize(NHits);
+  _BinStart.assign(NPhi+1, 0);
+
+  float RMax = 0;
+  for(unsigned h=0; h<NHits; h++){
+    _Phi[h] = atan2(Hits.Y[h], Hits.X[h]);
+    _R[h] = sqrt(Hits.Perp2(h));
+    RMax = max(RMax, _R[h]);
+    _BinStart[PhiBin(_Phi[h])+1]++;
+  }
+  for(int b=0; b<NPhi; b++) _BinStart[b+1] += _BinStart[b];
+
+  _BinFill.assign(_BinStart.begin(), _BinStart.end()-1);
+  _BinHits.resize(NHits);
+  for(unsigned h=0; h<NHits; h++) _BinHits[_BinFill[PhiBin(_Phi[h])]++] = h;
+
+  // largest |asin(Curv*r/2)| in the event, plus the rounding of both bins
+  const float MaxShift = asin(min(1.f, _Config.MaxCurv*RMax/2));
+  _Halo = (int)ceil(MaxShift/_PhiWidth) + 1;
+}
+
+void MplHoughFinder::FindSector(const MplHitCache &Hits, MplHoughSector &S) const {
+  const int NCurv = _Config.NCurv;
+  const unsigned MinHits = _Config.MinHits;
+  const int Width = S.End - S.Begin;
+
+  S.Candidates.clear();
+
+  VoteXY(S);
+
+  // local maxima in the sector's own bins; on a plateau only the first
+  // cell in (phi, curv) order is a peak
+  for(int p=1; p<=Width; p++){
+    for(int k=0; k<NCurv; k++){
+      const unsigned Votes = S.XY[p*NCurv + k];
+      if(Votes < MinHits) continue;
+
+      bool Peak = true;
+      for(int dp=-1; dp<=1 && Peak; dp++){
+        for(int dk=-1; dk<=1 && Peak; dk++){
+          if((dp == 0 && dk == 0) || k+dk < 0 || k+dk >= NCurv) continue;
+          const unsigned Other = S.XY[(p+dp)*NCurv + k+dk];
+          const bool Before = dp < 0 || (dp == 0 && dk < 0);
+          if(Before ? Other >= Votes : Other > Votes) Peak = false;
+        }
+      }
+      if(!Peak) continue;
+
+      MplHoughCandidate Cand;
+      const int Bin = S.Begin + p - 1;
+      Cand.Phi0 = PhiCentre(Bin);
+      Cand.Curv = CurvCentre(k);
+      Cand.Votes = Votes;
+
+      CollectRoad(Hits, Cand.Phi0, Cand.Curv, Bin, S);
+      if(S.Road.size() < MinHits) continue;
+      if(!VoteRZ(Hits, S, Cand)) continue;
+
+      Refine(Hits, S, Cand);
+      if(Cand.Hits.size() < MinHits) continue;
+
+      S.Candidates.push_back(Cand);
+    }
+  }
+}
+
+void MplHoughFinder::VoteXY(MplHoughSector &S) const {
+  const int NPhi = _Config.NPhi, NCurv = _Config.NCurv;
+  const int Width = S.End - S.Begin;
+
+  S.XY.assign((Width+2)*NCurv, 0);
+
+  // hit bins that can reach the sector or its edge bins, each bin once
+  const int First = S.Begin - 1 - _Halo;
+  const int NBins = min(Width + 2 + 2*_Halo, NPhi);
+
+  for(int i=0; i<NBins; i++){
+    const int b = Wrap(First + i, NPhi);
+    for(int j=_BinStart[b]; j<_BinStart[b+1]; j++){
+      const unsigned h = _BinHits[j];
+      const float Phi = _Phi[h], HalfR = _R[h]/2;
+
+      for(int k=0; k<NCurv; k++){
+        const float s = CurvCentre(k)*HalfR;
+        if(fabs(s) >= 1) continue;
+
+        // with a single sector a bin is both an own and an edge bin
+        const int Bin = (int)floor((Phi - asin(s) + M_PI)/_PhiWidth);
+        for(int l = Wrap(Bin - S.Begin + 1, NPhi); l < Width+2; l += NPhi){
+          unsigned short &Cell = S.XY[l*NCurv + k];
+          if(Cell < 0xffff) Cell++;
+        }
+      }
+    }
+  }
+}
+
+void MplHoughFinder::CollectRoad(const MplHitCache &Hits, float Phi0, float Curv, int PhiBin, MplHoughSector &S) const {
+  const int NPhi = _Config.NPhi;
+
+  S.Road.clear();
+
+  const int First = PhiBin - _Halo - 1;
+  const int NBins = min(2*_Halo + 3, NPhi);
+
+  for(int i=0; i<NBins; i++){
+    const int b = Wrap(First + i, NPhi);
+    for(int j=_BinStart[b]; j<_BinStart[b+1]; j++){
+      const unsigned h = _BinHits[j];
+      const float r = _R[h];
+      const float s = Curv*r/2;
+      if(r <= 0 || fabs(s) >= 1) continue;
+
+      // the bin centres are within half a bin of the track, allow a full
+      // bin in both parameters plus the hit error
+      const float Tol = _PhiWidth + _CurvWidth*r/2 + 3*sqrt(0.5*(Hits.FitCxx[h] + Hits.FitCyy[h]))/r;
+      if(fabs(DeltaPhi(_Phi[h], Phi0 + asin(s))) <= Tol) S.Road.push_back(h);
+    }
+  }
+}
+
+bool MplHoughFinder::VoteRZ(const MplHitCache &Hits, MplHoughSector &S, MplHoughCandidate &Cand) const {
+  const int NZ0 = _Config.NZ0, NRZCurv = _Config.NRZCurv, NSlope = _Config.NSlope;
+
+  S.RZ.assign(NZ0*NRZCurv*NSlope, 0);
+
+  // over a (Z0, RZCurv) cell the slope through a hit sweeps a range, the
+  // hit votes for every angle bin of it; with one bin per cell the votes
+  // of a track at small r are spread over neighbouring cells
+  for(unsigned i=0; i<S.Road.size(); i++){
+    const unsigned h = S.Road[i];
+    for(int iz=0; iz<NZ0; iz++){
+      for(int ic=0; ic<NRZCurv; ic++){
+        int First, Last;
+        AngleBins(Hits, h, iz, ic, First, Last);
+        unsigned short *Cell = &S.RZ[(iz*NRZCurv + ic)*NSlope];
+        for(int a=First; a<=Last; a++) if(Cell[a] < 0xffff) Cell[a]++;
+      }
+    }
+  }
+
+  // highest cell, the first one on ties
+  const unsigned Best = max_element(S.RZ.begin(), S.RZ.end()) - S.RZ.begin();
+  if(S.RZ[Best] < (unsigned)_Config.MinHits) return false;
+
+  const int a = Best % NSlope;
+  const int ic = (Best / NSlope) % NRZCurv;
+  const int iz = Best / (NSlope*NRZCurv);
+  Cand.Z0 = -_Config.MaxZ0 + (iz + 0.5)*_Z0Width;
+  Cand.RZCurv = -_Config.MaxRZCurv + (ic + 0.5)*_RZCurvWidth;
+  Cand.Slope = tan(-M_PI/2 + (a + 0.5)*_AngleWidth);
+
+  // the road hits that voted for the peak
+  S.Selected.clear();
+  for(unsigned i=0; i<S.Road.size(); i++){
+    int First, Last;
+    AngleBins(Hits, S.Road[i], iz, ic, First, Last);
+    if(First <= a && a <= Last) S.Selected.push_back(S.Road[i]);
+  }
+
+  return S.Selected.size() >= (unsigned)_Config.MinHits;
+}
+
+void MplHoughFinder::AngleBins(const MplHitCache &Hits, unsigned h, int iz, int ic, int &First, int &Last) const {
+  const float r = _R[h], z = Hits.Z[h];
+  const float Z0 = -_Config.MaxZ0 + iz*_Z0Width;
+  const float RZCurv = -_Config.MaxRZCurv + ic*_RZCurvWidth;
+
+  // the slope falls with Z0 and RZCurv, widened by the hit error
+  const float Err = 3*sqrt(Hits.FitCzz[h]);
+  const float Lo = atan((z - Err - Z0 - _Z0Width - (RZCurv + _RZCurvWidth)*r*r)/r);
+  const float Hi = atan((z + Err - Z0 - RZCurv*r*r)/r);
+  First = max((int)floor((Lo + M_PI/2)/_AngleWidth), 0);
+  Last = min((int)floor((Hi + M_PI/2)/_AngleWidth), _Config.NSlope-1);
+}
+
+void MplHoughFinder::Refine(const MplHitCache &Hits, MplHoughSector &S, MplHoughCandidate &Cand) const {
+  Cand.Hits.clear();
+
+  // the XY road is as wide as the noise it lets in, only the RZ view
+  // separates them; a coarse RZ cell still takes in noise hits, which
+  // pull the fit, so the worst hit is dropped until all are in the cut
+  MplFitResult Res;
+  if(!TrimRZ(Hits, S, Res)) return;
+
+  // road hits the coarse cell left out but on the fitted parabola
+  if(Res.Valid){
+    sort(S.Selected.begin(), S.Selected.end());
+    const unsigned NSelected = S.Selected.size();
+    for(unsigned i=0; i<S.Road.size(); i++){
+      const unsigned h = S.Road[i];
+      if(binary_search(S.Selected.begin(), S.Selected.begin() + NSelected, h)) continue;
+      if(PullRZ(Res, _R[h], Hits.Z[h], sqrt(Hits.FitRErr2(h)), sqrt(Hits.FitCzz[h])) <= _Config.PullCut)
+        S.Selected.push_back(h);
+    }
+  }
+
+  Cand.Hits = S.Selected;
+  sort(Cand.Hits.begin(), Cand.Hits.end());
+}
+
+bool MplHoughFinder::TrimRZ(const MplHitCache &Hits, MplHoughSector &S, MplFitResult &Res) const {
+  while(true){
+    const unsigned n = S.Selected.size();
+    if(n < (unsigned)_Config.MinHits) return false;
+
+    S.FitX.resize(n);
+    S.FitY.resize(n);
+    S.FitEX.resize(n);
+    S.FitEY.resize(n);
+    for(unsigned i=0; i<n; i++){
+      const unsigned h = S.Selected[i];
+      S.FitX[i] = _R[h];
+      S.FitY[i] = Hits.Z[h];
+      S.FitEX[i] = sqrt(Hits.FitRErr2(h));
+      S.FitEY[i] = sqrt(Hits.FitCzz[h]);
+    }
+
+    MplFit::FitParabola(n, &S.FitX[0], &S.FitY[0], &S.FitEX[0], &S.FitEY[0], Res);
+    if(!Res.Valid) return true;
+
+    int Worst = -1;
+    double WorstPull = _Config.PullCut;
+    for(unsigned i=0; i<n; i++){
+      const double Pull = PullRZ(Res, S.FitX[i], S.FitY[i], S.FitEX[i], S.FitEY[i]);
+      if(Pull > WorstPull){
+        WorstPull = Pull;
+        Worst = i;
+      }
+    }
+    if(Worst < 0) return true;
+    S.Selected.erase(S.Selected.begin() + Worst);
+  }
+}
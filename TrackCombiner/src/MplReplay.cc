@@ -0,0 +1,191 @@
+#include "Monopoles/TrackCombiner/interface/MplReplay.h"
+
+#include <cstring>
+
+namespace {
+  const char Magic[4] = {'M', 'P', 'L', 'R'};
+  // 2: saturated hits of the Hough finder after the track hits
+  const unsigned Version = 2;
+
+  template <class T>
+  bool WriteArray(FILE *File, const T *Data, unsigned n){
+    return n == 0 || fwrite(Data, sizeof(T), n, File) == n;
+  }
+
+  template <class T>
+  bool ReadArray(FILE *File, T *Data, unsigned n){
+    return n == 0 || fread(Data, sizeof(T), n, File) == n;
+  }
+
+  template <class T>
+  bool ReadVector(FILE *File, std::vector<T> &Data, unsigned n){
+    Data.resize(n);
+    return n == 0 || ReadArray(File, &Data[0], n);
+  }
+}
+
+MplReplayWriter::MplReplayWriter(const std::string &FileName) :
+  _File(fopen(FileName.c_str(), "wb")), _Error(false), _NEvents(0)
+{
+  if(!_File) return;
+
+  _Error = !WriteArray(_File, Magic, 4) || !WriteArray(_File, &Version, 1);
+}
+
+MplReplayWriter::~MplReplayWriter(){
+  if(_File) fclose(_File);
+}
+
+void MplReplayWriter::Write(const MplTrackEvent &Event){
+  if(!Good()) return;
+
+  const MplHitCache &Hits = Event.Hits;
+  const unsigned NTracks = Event.NTracks();
+  const unsigned NHits = Hits.NHits();
+
+  const unsigned Header[4] = {Event.Run, Event.Event, NTracks, NHits};
+  bool Ok = WriteArray(_File, Header, 4);
+
+  if(NTracks){
+    Ok = Ok && WriteArray(_File, &Event.Pt[0], NTracks);
+    Ok = Ok && WriteArray(_File, &Event.Eta[0], NTracks);
+    Ok = Ok && WriteArray(_File, &Event.Phi[0], NTracks);
+
+    _Int8.resize(NTracks);
+    for(unsigned i=0; i<NTracks; i++) _Int8[i] = Event.Charge[i];
+    Ok = Ok && WriteArray(_File, &_Int8[0], NTracks);
+
+    // tracks below the pt cut of the dumper have no hits
+    _Int32.resize(NTracks);
+    for(unsigned i=0; i<NTracks; i++) _Int32[i] = Hits.NTracks() == NTracks ? Hits.End(i) - Hits.Begin(i) : 0;
+    Ok = Ok && WriteArray(_File, &_Int32[0], NTracks);
+  }
+
+  Ok = Ok && WriteHits(Hits);
+
+  const unsigned NSatHits = Event.SatHits.NHits();
+  Ok = Ok && WriteArray(_File, &NSatHits, 1) && WriteHits(Event.SatHits);
+
+  if(Ok) _NEvents++;
+  else _Error = true;
+}
+
+bool MplReplayWriter::WriteHits(const MplHitCache &Hits){
+  const unsigned NHits = Hits.NHits();
+  if(NHits == 0) return true;
+
+  bool Ok = WriteArray(_File, &Hits.X[0], NHits);
+  Ok = Ok && WriteArray(_File, &Hits.Y[0], NHits);
+  Ok = Ok && WriteArray(_File, &Hits.Z[0], NHits);
+  Ok = Ok && WriteArray(_File, &Hits.Cxx[0], NHits);
+  Ok = Ok && WriteArray(_File, &Hits.Cyx[0], NHits);
+  Ok = Ok && WriteArray(_File, &Hits.Cyy[0], NHits);
+  Ok = Ok && WriteArray(_File, &Hits.Czz[0], NHits);
+  Ok = Ok && WriteArray(_File, &Hits.NormCharge[0], NHits);
+
+  _Int16.resize(2*NHits);
+  for(unsigned h=0; h<NHits; h++){
+    _Int16[h] = Hits.Strips[h];
+    _Int16[NHits+h] = Hits.SatStrips[h];
+  }
+  Ok = Ok && WriteArray(_File, &_Int16[0], 2*NHits);
+
+  _Int8.resize(NHits);
+  for(unsigned h=0; h<NHits; h++) _Int8[h] = Hits.ErrValid[h];
+  return Ok && WriteArray(_File, &_Int8[0], NHits);
+}
+
+MplReplayReader::MplReplayReader(const std::string &FileName) :
+  _File(fopen(FileName.c_str(), "rb")), _Error(false), _Version(0)
+{
+  if(!_File) return;
+
+  char FileMagic[4];
+  _Error = !ReadArray(_File, FileMagic, 4) || memcmp(FileMagic, Magic, 4) != 0
+    || !ReadArray(_File, &_Version, 1) || _Version < 1 || _Version > Version;
+}
+
+MplReplayReader::~MplReplayReader(){
+  if(_File) fclose(_File);
+}
+
+bool MplReplayReader::Read(MplTrackEvent &Event){
+  if(!Good()) return false;
+
+  unsigned Header[4];
+  const size_t NHeader = fread(Header, sizeof(unsigned), 4, _File);
+  if(NHeader == 0 && feof(_File)) return false;
+  if(NHeader != 4){
+    _Error = true;
+    return false;
+  }
+
+  Event.Clear();
+  Event.Run = Header[0];
+  Event.Event = Header[1];
+  const unsigned NTracks = Header[2];
+  const unsigned NHits = Header[3];
+
+  MplHitCache &Hits = Event.Hits;
+  Hits.Resize(NHits);
+
+  bool Ok = ReadVector(_File, Event.Pt, NTracks)
+    && ReadVector(_File, Event.Eta, NTracks)
+    && ReadVector(_File, Event.Phi, NTracks)
+    && ReadVector(_File, _Int8, NTracks);
+
+  Event.Charge.assign(_Int8.begin(), _Int8.end());
+
+  Ok = Ok && ReadVector(_File, _Int32, NTracks);
+  if(Ok){
+    Hits.TrackBegin.resize(NTracks+1);
+    Hits.TrackBegin[0] = 0;
+    for(unsigned i=0; i<NTracks; i++) Hits.TrackBegin[i+1] = Hits.TrackBegin[i] + _Int32[i];
+    Ok = Hits.TrackBegin[NTracks] == NHits;
+  }
+
+  Ok = Ok && ReadHits(Hits);
+
+  // version 1 files have no saturated hits
+  if(_Version >= 2){
+    unsigned NSatHits = 0;
+    Ok = Ok && ReadArray(_File, &NSatHits, 1);
+    if(Ok) Event.SatHits.Resize(NSatHits);
+    Ok = Ok && ReadHits(Event.SatHits);
+  }
+
+  if(!Ok){
+    _Error = true;
+    return false;
+  }
+
+  return true;
+}
+
+bool MplReplayReader::ReadHits(MplHitCache &Hits){
+  const unsigned NHits = Hits.NHits();
+  if(NHits == 0) return true;
+
+  bool Ok = ReadArray(_File, &Hits.X[0], NHits);
+  Ok = Ok && ReadArray(_File, &Hits.Y[0], NHits);
+  Ok = Ok && ReadArray(_File, &Hits.Z[0], NHits);
+  Ok = Ok && ReadArray(_File, &Hits.Cxx[0], NHits);
+  Ok = Ok && ReadArray(_File, &Hits.Cyx[0], NHits);
+  Ok = Ok && ReadArray(_File, &Hits.Cyy[0], NHits);
+  Ok = Ok && ReadArray(_File, &Hits.Czz[0], NHits);
+  Ok = Ok && ReadArray(_File, &Hits.NormCharge[0], NHits);
+  Ok = Ok && ReadVector(_File, _Int16, 2*NHits);
+  Ok = Ok && ReadVector(_File, _Int8, NHits);
+  if(!Ok) return false;
+
+  for(unsigned h=0; h<NHits; h++){
+    Hits.Strips[h] = _Int16[h];
+    Hits.SatStrips[h] = _Int16[NHits+h];
+    Hits.ErrValid[h] = _Int8[h];
+    Hits.Charge[h] = Hits.NormCharge[h];
+    Hits.Norm[h] = 1;
+    Hits.Cosine[h] = 1;
+  }
+
+  return true;
+}
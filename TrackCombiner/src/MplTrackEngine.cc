@@ -0,0 +1,717 @@
+#include "Monopoles/TrackCombiner/interface/MplTrackEngine.h"
+
+#include "TGraphErrors.h"
+#include "TFitResult.h"
+#include "TFitResultPtr.h"
+#include "TVirtualFitter.h"
+
+#include "tbb/task_scheduler_init.h"
+
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <cmath>
+
+using namespace std;
+
+namespace {
+  // eta range of the isolation grid, tracks outside go to the edge bins
+  const float IsoEtaMax = 3.0;
+
+  inline float DeltaPhi(float a, float b){
+    float d = a - b;
+    while(d > M_PI) d -= 2*M_PI;
+    while(d <= -M_PI) d += 2*M_PI;
+    return d;
+  }
+}
+
+MplTrackerConfig::MplTrackerConfig() :
+  PhiCut(0.5), Chi2Cut(5.0), PtCut(3.0), DeDxCut(5.0),
+  DefaultError(0.05*0.05), ErrorFudge(0.02*0.02),
+  MeVperADCPixel(3.61e-6), MeVperADCStrip(3.61e-6*265),
+  FitMode(kAnalyticFit), NThreads(1), TrackHitOutput(false),
+  DeDxMask(1 << MplDeDxEstimator::kMedian), DeDxTruncation(0.4),
+  SatFilter(false), SatFilterFraction(0.07), SatFilterMinStrips(2)
+{
+  SetIsoCone(0.4);
+}
+
+void MplTrackerConfig::SetIsoCone(float Cone){
+  // bins at least one cone wide, so a cone never reaches past the neighbours
+  IsoCone = Cone;
+  IsoNEta = max(1, (int)(2*IsoEtaMax/IsoCone));
+  IsoNPhi = max(1, (int)(2*M_PI/IsoCone));
+}
+
+void MplTrackEvent::Clear(){
+  Pt.clear();
+  Eta.clear();
+  Phi.clear();
+  Charge.clear();
+  Hits.Clear();
+  SatHits.Clear();
+}
+
+void MplTrackerResult::Clear(){
+  Sets.clear();
+
+  HitTrack.clear();
+  HitX.clear();
+  HitY.clear();
+  HitZ.clear();
+  HitErrX.clear();
+  HitErrY.clear();
+  HitErrZ.clear();
+  HitStrips.clear();
+  HitSatStrips.clear();
+}
+
+MplTrackerWorkspace::MplTrackerWorkspace(const MplTrackerConfig &Config) :
+  SeedSlope(0),
+  GroupBuilder(Config.Chi2Cut, Config.NThreads),
+  RZFunc(0), XYFunc(0),
+  DeDx(Config.DeDxTruncation),
+  Hough(Config.Hough, Config.NThreads),
+  NEvents(0), NValidated(0), NSatFilterTracks(0), NSatFilterPassed(0),
+  NHoughHits(0), NHoughSets(0)
+{
+  if(Config.FitMode != MplTrackerConfig::kAnalyticFit){
+    RZFunc = new TF1("RZFunc", "[0] + [1]*x + [2]*x^2", 0, 200);
+    // track starts along x axis, fit to semicircle:
+    //XYFunc = new TF1("XYFunc", "[0] + (sqrt(1 - ((x-[1])*[2])^2)-1)/[2]", 0, 200);
+    XYFunc = new TF1("XYFunc", "[0] + sqrt([2]^2 - (x-[1])^2)*TMath::Sign(1,[2]) - [2]", 0, 200);
+  }
+
+  AnalyticWatch.Reset();
+  RootWatch.Reset();
+  SatFilterWatch.Reset();
+  GroupWatch.Reset();
+  HoughWatch.Reset();
+  for(int i=0; i<3; i++){
+    MaxDiffXY[i] = 0;
+    MaxDiffRZ[i] = 0;
+  }
+}
+
+MplTrackerWorkspace::~MplTrackerWorkspace(){
+  delete RZFunc;
+  delete XYFunc;
+}
+
+MplTrackEngine::MplTrackEngine(const MplTrackerConfig &Config) :
+  _Config(Config), _Scheduler(0)
+{
+  if(_Config.NThreads > 1) _Scheduler = new tbb::task_scheduler_init(_Config.NThreads);
+}
+
+MplTrackEngine::~MplTrackEngine(){
+  delete _Scheduler;
+}
+
+string MplTrackEngine::Summary(const MplTrackerWorkspace &W) const {
+  if(W.NEvents == 0) return "";
+
+  ostringstream Text;
+  if(_Config.FitMode == MplTrackerConfig::kValidateFit){
+    const double Analytic = 1000*W.AnalyticWatch.CpuTime()/W.NEvents;
+    const double Root = 1000*W.RootWatch.CpuTime()/W.NEvents;
+    Text << "Fit validation over " << W.NEvents << " events, " << W.NValidated << " fits:\n"
+      << "  analytic " << Analytic << " ms/event, ROOT " << Root << " ms/event, speedup " << (Analytic > 0 ? Root/Analytic : 0) << "\n"
+      << "  max |analytic-ROOT|/err XY: " << W.MaxDiffXY[0] << " " << W.MaxDiffXY[1] << " " << W.MaxDiffXY[2]
+      << "  RZ: " << W.MaxDiffRZ[0] << " " << W.MaxDiffRZ[1] << " " << W.MaxDiffRZ[2];
+  }
+  if(_Config.SatFilter){
+    if(!Text.str().empty()) Text << "\n";
+    Text << "Saturation filter over " << W.NEvents << " events: "
+      << W.NSatFilterPassed << " of " << W.NSatFilterTracks << " tracks above the pt cut passed ("
+      << (W.NSatFilterTracks ? 100.*W.NSatFilterPassed/W.NSatFilterTracks : 0) << "%), "
+      << 1000*W.SatFilterWatch.CpuTime()/W.NEvents << " ms/event, then grouping "
+      << 1000*W.GroupWatch.CpuTime()/W.NEvents << " ms/event";
+  }
+  if(_Config.Hough.Enable){
+    if(!Text.str().empty()) Text << "\n";
+    Text << "Hough finder over " << W.NEvents << " events: "
+      << float(W.NHoughHits)/W.NEvents << " saturated hits/event, "
+      << float(W.NHoughSets)/W.NEvents << " candidates/event, "
+      << 1000*W.HoughWatch.CpuTime()/W.NEvents << " ms/event";
+  }
+  return Text.str();
+}
+
+void MplTrackEngine::PrepareHits(MplHitCache &Hits) const {
+  for(unsigned h=0; h<Hits.NHits(); h++){
+    const float r2 = Hits.Perp2(h);
+
+    // raw errors for the hit output, fudged or default errors for the fits;
+    // if errors are huge, treat them as invalid
+    if(Hits.ErrValid[h] && Hits.Cxx[h] <= 100 && Hits.Cyy[h] <= 100 && Hits.Czz[h] <= 100){
+      Hits.FitCxx[h] = Hits.Cxx[h] + _Config.ErrorFudge*r2; //error bars are too small.
+      Hits.FitCyx[h] = Hits.Cyx[h];
+      Hits.FitCyy[h] = Hits.Cyy[h] + _Config.ErrorFudge*r2;
+      Hits.FitCzz[h] = Hits.Czz[h] + _Config.ErrorFudge*r2;
+    }else{
+      Hits.FitCxx[h] = Hits.FitCyy[h] = Hits.FitCzz[h] = _Config.DefaultError*r2;
+      Hits.FitCyx[h] = 0;
+    }
+
+    //Added dedx cut:
+    const int Strips = Hits.Strips[h], SatStrips = Hits.SatStrips[h];
+    const float NormCharge = Hits.NormCharge[h];
+    const bool Fit = !(NormCharge > 0 && NormCharge < _Config.DeDxCut);
+    Hits.Fit[h] = Fit;
+    Hits.Use[h] = Fit && !(SatStrips>=18 && SatStrips>=Strips-5);
+  }
+}
+
+void MplTrackEngine::Process(const MplTrackEvent &Event, MplTrackerWorkspace &W, MplTrackerResult &Result) const {
+  const unsigned NTracks = Event.NTracks();
+
+  W.NEvents++;
+
+  W.Used.assign(NTracks, false);
+  Result.Clear();
+
+  SelectSeeds(Event, W);
+  BuildPhiIndex(Event, W);
+  BuildIsoGrid(Event, W);
+
+  if(_Config.TrackHitOutput) FillHitOutput(Event, Result);
+
+  W.GroupWatch.Start(kFALSE);
+
+  // Loop over the tracks
+  for(uint i = 0; i!=NTracks; i++){
+    if(!W.Seed[i]) continue;
+
+    // skip this if it's already used:
+    if (W.Used[i]) continue;
+
+    vector<int> Group(1, i);
+
+    W.Hits.clear();
+
+    // the seed direction sets the r error weighting of the running RZ sums
+    W.Moments.Reset();
+    W.SeedSlope = sinh(Event.Eta[i]);
+
+    AddPoints(Event, W, i);
+
+    AddMoreTracks(Event, W, Group);
+
+    Result.Sets.push_back(MplTrackSet());
+    MplTrackSet &Set = Result.Sets.back();
+    Set.Finder = MplTrackSet::kTrackFinder;
+    Set.Group = Group;
+
+    FitXY(Event.Hits, W, GroupRadius(Event, Group), Set);
+    FitRZ(Event.Hits, W, Set);
+    AverageIso(Event, W, Group, Event.Eta[Group[0]], Event.Phi[Group[0]], Set);
+    FitDeDx(Event.Hits, W, Set);
+    CountHits(Event.Hits, W, Set);
+
+    //cout << "Just Fitted.  Points: " << W.Hits.size() << endl;
+
+    for (uint j=0; j<Group.size(); j++)
+      W.Used[Group[j]] = true;
+  }
+
+  W.GroupWatch.Stop();
+
+  if(_Config.Hough.Enable) ProcessHough(Event, W, Result);
+}
+
+namespace {
+  // more hits first, then Phi0 order
+  struct MoreHits {
+    bool operator()(const pair<int,unsigned> &a, const pair<int,unsigned> &b) const { return a.first > b.first; }
+  };
+}
+
+void MplTrackEngine::ProcessHough(const MplTrackEvent &Event, MplTrackerWorkspace &W, MplTrackerResult &Result) const {
+  const MplHitCache &Hits = Event.SatHits;
+  const vector<int> NoTracks;
+
+  W.HoughWatch.Start(kFALSE);
+
+  W.Hough.Find(Hits, W.HoughCandidates);
+  W.NHoughHits += Hits.NHits();
+
+  W.HoughOrder.clear();
+  for(uint c=0; c<W.HoughCandidates.size(); c++)
+    W.HoughOrder.push_back(make_pair((int)W.HoughCandidates[c].Hits.size(), c));
+  stable_sort(W.HoughOrder.begin(), W.HoughOrder.end(), MoreHits());
+
+  // neighbouring peaks of one monopole share their hits: each hit goes to
+  // the candidate with the most hits, the others keep what is left
+  W.HoughUsed.assign(Hits.NHits(), 0);
+  for(uint o=0; o<W.HoughOrder.size(); o++){
+    const MplHoughCandidate &Cand = W.HoughCandidates[W.HoughOrder[o].second];
+
+    // same hit selection as the track groups
+    W.Hits.clear();
+    for(uint i=0; i<Cand.Hits.size(); i++){
+      const unsigned h = Cand.Hits[i];
+      if(!W.HoughUsed[h] && Hits.Fit[h]) W.Hits.push_back(h);
+    }
+    if(W.Hits.size() < (uint)_Config.Hough.MinHits) continue;
+
+    for(uint i=0; i<W.Hits.size(); i++) W.HoughUsed[W.Hits[i]] = 1;
+
+    Result.Sets.push_back(MplTrackSet());
+    MplTrackSet &Set = Result.Sets.back();
+    Set.Finder = MplTrackSet::kHoughFinder;
+
+    FitXY(Hits, W, Cand.Curv != 0 ? 1/Cand.Curv : 1e4, Set);
+    FitRZ(Hits, W, Set);
+    AverageIso(Event, W, NoTracks, asinh(Cand.Slope), Cand.Phi0, Set);
+    FitDeDx(Hits, W, Set);
+    CountHits(Hits, W, Set);
+
+    W.NHoughSets++;
+  }
+
+  W.HoughWatch.Stop();
+}
+
+void MplTrackEngine::AddMoreTracks(const MplTrackEvent &Event, MplTrackerWorkspace &W, vector<int> &Group) const {
+  //cout << "Checking: " << Group[0] << " " << Event.Phi[Group[0]] << endl;
+
+  // tracks within PhiCut of the seed, above the pt cut, in index order
+  FindPhiCandidates(W, Event.Phi[Group[0]], Group[0], W.Candidates);
+
+  if(_Config.FitMode != MplTrackerConfig::kRootFit){
+    // trial decisions from the running sums, the full fit is done once per group
+    W.GroupBuilder.AddCandidates(Event.Hits, W.Candidates, W.Used, W.SeedSlope, W.Moments, W.Hits, Group);
+    return;
+  }
+
+  for(uint c = 0; c!=W.Candidates.size(); c++){
+    int i = W.Candidates[c];
+    if(W.Used[i]) continue;
+
+    // state before the trial, restored if the track is rejected
+    const unsigned NHits = W.Hits.size();
+    const MplFitMoments Moments = W.Moments;
+
+    int NPoints = AddPoints(Event, W, i);
+    if(NPoints == 0){
+      W.Hits.resize(NHits);
+      W.Moments = Moments;
+      continue;
+    }
+
+    MplTrackSet Set;
+    FitXY(Event.Hits, W, GroupRadius(Event, Group), Set);
+    //cout << " Chi2XY: " << Set.Chi2XY / Set.Ndof << endl;
+    if(Set.Ndof > 0 && Set.Chi2XY / Set.Ndof > _Config.Chi2Cut){
+      W.Hits.resize(NHits);
+      W.Moments = Moments;
+      continue;
+    }
+
+    FitRZ(Event.Hits, W, Set);
+    //cout << " Chi2RZ: " << Set.Chi2RZ / Set.Ndof << endl;
+    if(Set.Ndof > 0 && Set.Chi2RZ / Set.Ndof > _Config.Chi2Cut){
+      W.Hits.resize(NHits);
+      W.Moments = Moments;
+      continue;
+    }
+
+    //cout << " Good!" << endl;
+    Group.push_back(i);
+  }
+}
+
+int MplTrackEngine::AddPoints(const MplTrackEvent &Event, MplTrackerWorkspace &W, unsigned iTrack) const {
+  int NPoints = MplGroupBuilder::AddTrackHits(Event.Hits, iTrack, W.SeedSlope, W.Moments, &W.Hits);
+
+  //cout << "Just Added " << NPoints << ".  Size: " << W.Hits.size() << endl;
+
+  return NPoints;
+}
+
+namespace {
+  struct PhiLess {
+    bool operator()(const pair<float,int> &a, float b) const { return a.first < b; }
+    bool operator()(float a, const pair<float,int> &b) const { return a < b.first; }
+  };
+}
+
+void MplTrackEngine::SelectSeeds(const MplTrackEvent &Event, MplTrackerWorkspace &W) const {
+  const MplHitCache &Hits = Event.Hits;
+  const unsigned NTracks = Event.NTracks();
+
+  W.Seed.resize(NTracks);
+  for(uint i=0; i<NTracks; i++) W.Seed[i] = Event.Pt[i] >= _Config.PtCut;
+  if(!_Config.SatFilter) return;
+
+  W.SatFilterWatch.Start(kFALSE);
+
+  // strip counts summed over all hits of the track, cached by the hit
+  // filling; no positions are read.  A track without hits was dropped by
+  // the pre-filter of MplTrackFinder and fails here too
+  for(uint i=0; i<NTracks; i++){
+    if(!W.Seed[i]) continue;
+    if(Hits.End(i) == Hits.Begin(i)){
+      W.Seed[i] = false;
+      W.NSatFilterTracks++;
+      continue;
+    }
+
+    int Strips = 0, SatStrips = 0;
+    for(unsigned h=Hits.Begin(i); h<Hits.End(i); h++){
+      Strips += Hits.Strips[h];
+      SatStrips += Hits.SatStrips[h];
+    }
+
+    W.Seed[i] = _Config.SatSelect(Strips, SatStrips);
+    W.NSatFilterTracks++;
+    if(W.Seed[i]) W.NSatFilterPassed++;
+  }
+
+  W.SatFilterWatch.Stop();
+}
+
+void MplTrackEngine::BuildPhiIndex(const MplTrackEvent &Event, MplTrackerWorkspace &W) const {
+  W.PhiIndex.clear();
+
+  for(uint i=0; i<Event.NTracks(); i++){
+    if(!W.Seed[i]) continue;
+    W.PhiIndex.push_back(make_pair(Event.Phi[i], (int)i));
+  }
+
+  sort(W.PhiIndex.begin(), W.PhiIndex.end());
+}
+
+void MplTrackEngine::AddPhiRange(const MplTrackerWorkspace &W, float Lo, float Hi, int Seed, vector<int> &Candidates) const {
+  vector<pair<float,int> >::const_iterator Begin = lower_bound(W.PhiIndex.begin(), W.PhiIndex.end(), Lo, PhiLess());
+  vector<pair<float,int> >::const_iterator End = upper_bound(Begin, W.PhiIndex.end(), Hi, PhiLess());
+
+  for(; Begin != End; ++Begin)
+    if(Begin->second > Seed) Candidates.push_back(Begin->second);
+}
+
+void MplTrackEngine::FindPhiCandidates(const MplTrackerWorkspace &W, float Phi0, int Seed, vector<int> &Candidates) const {
+  Candidates.clear();
+
+  const float Lo = Phi0 - _Config.PhiCut;
+  const float Hi = Phi0 + _Config.PhiCut;
+
+  // split the window where it crosses the -pi/pi seam
+  if(_Config.PhiCut >= M_PI){
+    AddPhiRange(W, -M_PI, M_PI, Seed, Candidates);
+  }else if(Lo < -M_PI){
+    AddPhiRange(W, Lo + 2*M_PI, M_PI, Seed, Candidates);
+    AddPhiRange(W, -M_PI, Hi, Seed, Candidates);
+  }else if(Hi > M_PI){
+    AddPhiRange(W, Lo, M_PI, Seed, Candidates);
+    AddPhiRange(W, -M_PI, Hi - 2*M_PI, Seed, Candidates);
+  }else{
+    AddPhiRange(W, Lo, Hi, Seed, Candidates);
+  }
+
+  // keep the original track order of the serial grouping
+  sort(Candidates.begin(), Candidates.end());
+}
+
+void MplTrackEngine::FillHitOutput(const MplTrackEvent &Event, MplTrackerResult &Result) const {
+  const MplHitCache &Hits = Event.Hits;
+
+  // one entry per valid hit, all TrackHit_ branches aligned
+  for(uint iTrack=0; iTrack<Hits.NTracks(); iTrack++){
+    for(unsigned h=Hits.Begin(iTrack); h<Hits.End(iTrack); h++){
+      Result.HitTrack.push_back(iTrack);
+      Result.HitX.push_back(Hits.X[h]);
+      Result.HitY.push_back(Hits.Y[h]);
+      Result.HitZ.push_back(Hits.Z[h]);
+      Result.HitErrX.push_back(sqrt(Hits.Cxx[h]));
+      Result.HitErrY.push_back(sqrt(Hits.Cyy[h]));
+      Result.HitErrZ.push_back(sqrt(Hits.Czz[h]));
+      Result.HitStrips.push_back(Hits.Strips[h]);
+      Result.HitSatStrips.push_back(Hits.SatStrips[h]);
+    }
+  }
+}
+
+void MplTrackEngine::CountHits(const MplHitCache &Cache, const MplTrackerWorkspace &W, MplTrackSet &Set) const {
+  int Hits = 0, SatHits=0, SubHits = 0, SatSubHits=0;
+
+  for(uint i=0; i<W.Hits.size(); i++){
+    if(!Cache.Use[W.Hits[i]]) continue;
+    const int Strips = Cache.Strips[W.Hits[i]];
+    const int SatStrips = Cache.SatStrips[W.Hits[i]];
+
+    Hits++;
+    if(2*SatStrips>=Strips) SatHits++;
+
+    SubHits += Strips;
+    SatSubHits += SatStrips;
+  }
+
+  Set.Hits = Hits;
+  Set.SatHits = SatHits;
+  Set.SubHits = SubHits;
+  Set.SatSubHits = SatSubHits;
+}
+
+float MplTrackEngine::GroupRadius(const MplTrackEvent &Event, const vector<int> &Group) const {
+  float AvePt = 0;
+  for(uint i=0; i<Group.size(); i++)
+    AvePt += Event.Pt[Group[i]] * Event.Charge[Group[i]];
+  AvePt /= Group.size();
+
+  return AvePt/0.0114;
+}
+
+void MplTrackEngine::FitXY(const MplHitCache &Hits, MplTrackerWorkspace &W, float Radius, MplTrackSet &Set) const {
+  int NumPoints = W.Hits.size();
+  if(NumPoints == 0){
+    MplFitResult Empty;
+    Empty.Reset(0);
+    SetXYResult(Empty, 0, Set);
+    return;
+  }
+
+  //cout << endl;
+
+  // rotate so the initial path is along the x axis
+  const unsigned First = W.Hits[0], Last = W.Hits[NumPoints-1];
+  float RStart = Hits.Perp2(First);
+  float REnd = Hits.Perp2(Last);
+  float Phi0;
+  if(RStart > REnd) Phi0 = atan2(Hits.Y[First], Hits.X[First]);
+  else Phi0 = atan2(Hits.Y[Last], Hits.X[Last]);
+
+  const double CosPhi0 = cos(Phi0), SinPhi0 = sin(Phi0);
+
+  W.FitX.resize(NumPoints);
+  W.FitY.resize(NumPoints);
+  W.FitEX.resize(NumPoints);
+  W.FitEY.resize(NumPoints);
+
+  for(int i=0; i<NumPoints; i++){
+    const unsigned h = W.Hits[i];
+    const float x = Hits.X[h], y = Hits.Y[h];
+    const float cxx = Hits.FitCxx[h], cyx = Hits.FitCyx[h], cyy = Hits.FitCyy[h];
+    //cout << "XYFitter: " << x << " " << y << " " << sqrt(cxx) << " " << sqrt(cyy) << endl;
+    W.FitX[i] = x*CosPhi0+y*SinPhi0;
+    W.FitY[i] = -x*SinPhi0+y*CosPhi0;
+    W.FitEX[i] = sqrt(cxx*CosPhi0*CosPhi0 + cyy*SinPhi0*SinPhi0 + 2*cyx*SinPhi0*CosPhi0);
+    W.FitEY[i] = sqrt(cxx*SinPhi0*SinPhi0 + cyy*CosPhi0*CosPhi0 - 2*cyx*SinPhi0*CosPhi0);
+    //cout << "Trans: " << NewX << " " << NewY << " " << ErrorX << " " << ErrorY << endl;
+  }
+
+  MplFitResult Result;
+  if(_Config.FitMode == MplTrackerConfig::kRootFit){
+    RootFitXY(W, Radius, Result);
+  }else{
+    if(_Config.FitMode == MplTrackerConfig::kValidateFit) W.AnalyticWatch.Start(kFALSE);
+    MplFit::FitCircle(NumPoints, &W.FitX[0], &W.FitY[0], &W.FitEX[0], &W.FitEY[0], Result);
+    if(_Config.FitMode == MplTrackerConfig::kValidateFit){
+      W.AnalyticWatch.Stop();
+
+      MplFitResult RootResult;
+      W.RootWatch.Start(kFALSE);
+      RootFitXY(W, Radius, RootResult);
+      W.RootWatch.Stop();
+
+      Validate(W, Result, RootResult, W.MaxDiffXY);
+      if(!Result.Valid) Result = RootResult;
+    }else if(!Result.Valid){
+      // degenerate hits, e.g. all at one point: leave them to MINUIT
+      RootFitXY(W, Radius, Result);
+    }
+  }
+
+  SetXYResult(Result, Phi0, Set);
+
+  //cout << Set.XYPar[0] << " " << Set.XYPar[1] << " " << Set.XYPar[2] << endl;
+}
+
+void MplTrackEngine::RootFitXY(MplTrackerWorkspace &W, float Radius, MplFitResult &Res) const {
+  int NumPoints = W.FitX.size();
+  TGraphErrors XYGraph(NumPoints, &W.FitX[0], &W.FitY[0], &W.FitEX[0], &W.FitEY[0]);
+
+  W.XYFunc->SetParameters(1, 1, Radius);
+  //W.XYFunc->SetParLimits(2, -XMax, XMax);
+  TFitResultPtr Result = XYGraph.Fit(W.XYFunc, "Q S B");
+
+  CopyRootResult(W, Result, Res);
+}
+
+void MplTrackEngine::SetXYResult(const MplFitResult &Res, float Phi0, MplTrackSet &Set) const {
+  Set.XYPar[0] = sqrt(pow(Res.Par[0]-Res.Par[2],2)+pow(Res.Par[1],2)) - fabs(Res.Par[2]); // unsigned d0
+  Set.XYErr[0] = Res.Err[0]; // not correct right now
+  Set.XYPar[1] = Phi0 - atan(Res.Par[1]/(Res.Par[2]-Res.Par[0])); // phi0
+  Set.XYErr[1] = Res.Err[1]; // not correct right now
+  Set.XYPar[2] = Res.Par[2]; // radius
+  Set.XYErr[2] = Res.Err[2];
+  Set.Chi2XY = Res.Chi2;
+  Set.Ndof = Res.Ndof;
+}
+
+void MplTrackEngine::FitRZ(const MplHitCache &Hits, MplTrackerWorkspace &W, MplTrackSet &Set, bool Debug) const {
+  int NumPoints = W.Hits.size();
+
+  if(Debug) cout << endl;
+
+  W.FitX.resize(NumPoints);
+  W.FitY.resize(NumPoints);
+  W.FitEX.resize(NumPoints);
+  W.FitEY.resize(NumPoints);
+
+  for(int i=0; i<NumPoints; i++){
+    const unsigned h = W.Hits[i];
+    if(Debug){
+      cout << Hits.X[h] << " " << Hits.Y[h] << " " << Hits.Z[h] << " "
+	   << sqrt(Hits.FitCxx[h]) << " " << sqrt(Hits.FitCyy[h]) << " " << sqrt(Hits.FitCzz[h]) << endl;
+    }
+    W.FitX[i] = sqrt(Hits.Perp2(h));
+    W.FitY[i] = Hits.Z[h];
+    W.FitEX[i] = sqrt(Hits.FitRErr2(h));
+    W.FitEY[i] = sqrt(Hits.FitCzz[h]);
+  }
+
+  MplFitResult Result;
+  if(_Config.FitMode == MplTrackerConfig::kRootFit){
+    RootFitRZ(W, Result);
+  }else{
+    if(_Config.FitMode == MplTrackerConfig::kValidateFit) W.AnalyticWatch.Start(kFALSE);
+    MplFit::FitParabola(NumPoints, &W.FitX[0], &W.FitY[0], &W.FitEX[0], &W.FitEY[0], Result);
+    if(_Config.FitMode == MplTrackerConfig::kValidateFit){
+      W.AnalyticWatch.Stop();
+
+      MplFitResult RootResult;
+      W.RootWatch.Start(kFALSE);
+      RootFitRZ(W, RootResult);
+      W.RootWatch.Stop();
+
+      Validate(W, Result, RootResult, W.MaxDiffRZ);
+    }
+  }
+
+  for(int i=0; i<3; i++){
+    Set.RZPar[i] = Result.Par[i];
+    Set.RZErr[i] = Result.Err[i];
+  }
+  Set.Chi2RZ = Result.Chi2;
+}
+
+void MplTrackEngine::RootFitRZ(MplTrackerWorkspace &W, MplFitResult &Res) const {
+  int NumPoints = W.FitX.size();
+  TGraphErrors RZGraph(NumPoints, &W.FitX[0], &W.FitY[0], &W.FitEX[0], &W.FitEY[0]);
+
+  W.RZFunc->SetParameters(0,0,0); //1,-1,0.01);
+  TFitResultPtr Result = RZGraph.Fit(W.RZFunc, "Q S");
+
+  CopyRootResult(W, Result, Res);
+}
+
+void MplTrackEngine::CopyRootResult(const MplTrackerWorkspace &W, const TFitResultPtr &Result, MplFitResult &Res) const {
+  Res.Reset(W.FitX.size());
+  if(Result.Get() == NULL) return;
+
+  for(int i=0; i<3; i++){
+    Res.Par[i] = Result->Parameter(i);
+    Res.Err[i] = Result->ParError(i);
+  }
+  Res.Chi2 = Result->Chi2();
+  Res.Ndof = Result->Ndf();
+  Res.Valid = Result->IsValid();
+}
+
+void MplTrackEngine::Validate(MplTrackerWorkspace &W, const MplFitResult &Analytic, const MplFitResult &Root, float *MaxDiff) const {
+  W.NValidated++;
+  if(!Analytic.Valid || !Root.Valid) return;
+
+  // track the largest difference in units of the ROOT parameter error
+  for(int i=0; i<3; i++){
+    if(Root.Err[i] <= 0) continue;
+    float Diff = fabs(Analytic.Par[i] - Root.Par[i]) / Root.Err[i];
+    if(Diff > MaxDiff[i]) MaxDiff[i] = Diff;
+  }
+}
+
+void MplTrackEngine::FitDeDx(const MplHitCache &Hits, MplTrackerWorkspace &W, MplTrackSet &Set) const {
+  for(int i=0; i<MplDeDxEstimator::kNEstimators; i++) Set.DeDx[i] = 0;
+  if(_Config.DeDxMask == 0) return;
+
+  // pixels and ignored hits have negative charges and are skipped, hits
+  // with a saturated core are only fitted
+  W.DeDx.Clear();
+  for(uint i=0; i<W.Hits.size(); i++)
+    if(Hits.Use[W.Hits[i]]) W.DeDx.Add(Hits.NormCharge[W.Hits[i]]);
+
+  W.DeDx.Compute(_Config.DeDxMask, Set.DeDx);
+}
+
+void MplTrackEngine::BuildIsoGrid(const MplTrackEvent &Event, MplTrackerWorkspace &W) const {
+  const unsigned NTracks = Event.NTracks();
+
+  W.IsoBinStart.assign(_Config.IsoNEta*_Config.IsoNPhi + 1, 0);
+  W.IsoTracks.resize(NTracks);
+  W.IsoBin.resize(NTracks);
+  W.InGroup.assign(NTracks, false);
+
+  // counting sort of the track indices by bin
+  for(uint i=0; i<NTracks; i++){
+    W.IsoBin[i] = IsoEtaBin(Event.Eta[i])*_Config.IsoNPhi + IsoPhiBin(Event.Phi[i]);
+    W.IsoBinStart[W.IsoBin[i]+1]++;
+  }
+  for(uint b=0; b<W.IsoBinStart.size()-1; b++) W.IsoBinStart[b+1] += W.IsoBinStart[b];
+
+  W.IsoFill.assign(W.IsoBinStart.begin(), W.IsoBinStart.end()-1);
+  for(uint i=0; i<NTracks; i++) W.IsoTracks[W.IsoFill[W.IsoBin[i]]++] = i;
+}
+
+int MplTrackEngine::IsoEtaBin(float Eta) const {
+  int b = (int)floor((Eta + IsoEtaMax) * _Config.IsoNEta / (2*IsoEtaMax));
+  return min(max(b, 0), _Config.IsoNEta-1);
+}
+
+int MplTrackEngine::IsoPhiBin(float Phi) const {
+  int b = (int)floor((Phi + M_PI) * _Config.IsoNPhi / (2*M_PI));
+  return min(max(b, 0), _Config.IsoNPhi-1);
+}
+
+void MplTrackEngine::AverageIso(const MplTrackEvent &Event, MplTrackerWorkspace &W, const vector<int> &Group,
+                                float InitEta, float InitPhi, MplTrackSet &Set) const {
+  const float Cone2 = _Config.IsoCone*_Config.IsoCone;
+  float IsoPt = 0;
+
+  for(uint j=0; j<Group.size(); j++) W.InGroup[Group[j]] = true;
+
+  const int EtaBin = IsoEtaBin(InitEta);
+  const int PhiBin = IsoPhiBin(InitPhi);
+
+  // neighbouring phi bins, without visiting a bin twice when there are few
+  int PhiBins[3], NPhiBins = 0;
+  if(_Config.IsoNPhi < 3){
+    for(int p=0; p<_Config.IsoNPhi; p++) PhiBins[NPhiBins++] = p;
+  }else{
+    PhiBins[NPhiBins++] = (PhiBin + _Config.IsoNPhi - 1) % _Config.IsoNPhi;
+    PhiBins[NPhiBins++] = PhiBin;
+    PhiBins[NPhiBins++] = (PhiBin + 1) % _Config.IsoNPhi;
+  }
+
+  for(int e = max(EtaBin-1, 0); e <= min(EtaBin+1, _Config.IsoNEta-1); e++){
+    for(int p=0; p<NPhiBins; p++){
+      const int b = e*_Config.IsoNPhi + PhiBins[p];
+      for(int k = W.IsoBinStart[b]; k < W.IsoBinStart[b+1]; k++){
+        const int i = W.IsoTracks[k];
+        if(W.InGroup[i]) continue;
+
+        const float dEta = Event.Eta[i] - InitEta;
+        const float dPhi = DeltaPhi(Event.Phi[i], InitPhi);
+        if(dEta*dEta + dPhi*dPhi > Cone2) continue;
+
+        IsoPt += Event.Pt[i];
+      }
+    }
+  }
+
+  for(uint j=0; j<Group.size(); j++) W.InGroup[Group[j]] = false;
+
+  Set.Iso = IsoPt;
+}
@@ -0,0 +1,347 @@
+#include "Monopoles/TrackCombiner/interface/MplTrackFinder.h"
+
+#include "FWCore/MessageLogger/interface/MessageLogger.h"
+#include "FWCore/Utilities/interface/Exception.h"
+
+#include "Monopoles/MonoAlgorithms/interface/MonoStripAmplitudes.h"
+
+#include "DataFormats/GeometryCommonDetAlgo/interface/ErrorFrameTransformer.h"
+#include "DataFormats/TrackerRecHit2D/interface/SiStripRecHit2DCollection.h"
+#include "FWCore/Utilities/interface/InputTag.h"
+
+#include <cmath>
+
+using namespace std; using namespace edm;
+
+MplTrackerConfig::MplTrackerConfig(const ParameterSet& parameterSet, const std::string &Prefix){
+  Source = parameterSet.getParameter<std::string>(Prefix+"Source");
+  PhiCut = parameterSet.getUntrackedParameter<double>(Prefix+"PhiCut", 0.5);
+  Chi2Cut = parameterSet.getUntrackedParameter<double>(Prefix+"Chi2Cut", 5.0);
+  PtCut = parameterSet.getUntrackedParameter<double>(Prefix+"PtCut", 3.0);
+  DeDxCut = parameterSet.getUntrackedParameter<double>(Prefix+"DeDxCut", 5.0);
+  DefaultError = pow(parameterSet.getUntrackedParameter<double>(Prefix+"DefaultError", 0.05), 2);
+  ErrorFudge = pow(parameterSet.getUntrackedParameter<double>(Prefix+"ErrorFudge", 0.02), 2);
+
+  MeVperADCPixel = parameterSet.getUntrackedParameter<double>(Prefix+"MeVperADCPixel", 3.61e-6);
+  MeVperADCStrip = parameterSet.getUntrackedParameter<double>(Prefix+"MeVperADCStrip", 3.61e-6*265);
+
+  // same name for every prefix
+  TrackHitOutput = parameterSet.getUntrackedParameter<bool>("TrackHitOutput", false);
+
+  // candidate tests on more than one thread give the same groups as on one
+  NThreads = parameterSet.getUntrackedParameter<int>(Prefix+"Threads", 1);
+
+  // Analytic: closed-form fits, Root: TF1 fits, Validate: both, analytic results are kept
+  std::string Mode = parameterSet.getUntrackedParameter<std::string>(Prefix+"FitMode", "Analytic");
+  if(Mode == "Root") FitMode = kRootFit;
+  else if(Mode == "Validate") FitMode = kValidateFit;
+  else FitMode = kAnalyticFit;
+
+  SetIsoCone(parameterSet.getUntrackedParameter<double>(Prefix+"IsoCone", 0.4));
+
+  // any of Median, TruncatedMean, Harmonic2, LandauMPV
+  std::vector<std::string> Estimators = parameterSet.getUntrackedParameter<std::vector<std::string> >(Prefix+"DeDxEstimators", std::vector<std::string>(1, "Median"));
+  DeDxMask = 0;
+  for(uint i=0; i<Estimators.size(); i++){
+    const int e = MplDeDxEstimator::Find(Estimators[i]);
+    if(e < 0) throw cms::Exception("Configuration") << "Unknown dE/dx estimator " << Estimators[i];
+    DeDxMask |= 1 << e;
+  }
+  DeDxTruncation = parameterSet.getUntrackedParameter<double>(Prefix+"DeDxTruncation", 0.4);
+
+  // tracks with fewer saturated strips than SatFilterFraction of their strips
+  // (0.07 is the rate of ordinary tracks in the dE/dx significance) or than
+  // SatFilterMinStrips are not combined; off by default
+  SatFilter = parameterSet.getUntrackedParameter<bool>(Prefix+"SatFilter", false);
+  SatFilterFraction = parameterSet.getUntrackedParameter<double>(Prefix+"SatFilterFraction", 0.07);
+  SatFilterMinStrips = parameterSet.getUntrackedParameter<int>(Prefix+"SatFilterMinStrips", 2);
+
+  // Hough finder on the saturated strip hits, defaults in MplHoughConfig
+  Hough.Enable = parameterSet.getUntrackedParameter<bool>(Prefix+"Hough", Hough.Enable);
+  Hough.Sources = parameterSet.getUntrackedParameter<std::vector<std::string> >(Prefix+"HoughSources", Hough.Sources);
+  Hough.SatFraction = parameterSet.getUntrackedParameter<double>(Prefix+"HoughSatFraction", Hough.SatFraction);
+  Hough.MinSatStrips = parameterSet.getUntrackedParameter<int>(Prefix+"HoughMinSatStrips", Hough.MinSatStrips);
+  Hough.MinHits = parameterSet.getUntrackedParameter<int>(Prefix+"HoughMinHits", Hough.MinHits);
+  Hough.NSectors = parameterSet.getUntrackedParameter<int>(Prefix+"HoughSectors", Hough.NSectors);
+  Hough.NPhi = parameterSet.getUntrackedParameter<int>(Prefix+"HoughPhiBins", Hough.NPhi);
+  Hough.NCurv = parameterSet.getUntrackedParameter<int>(Prefix+"HoughCurvBins", Hough.NCurv);
+  Hough.MaxCurv = parameterSet.getUntrackedParameter<double>(Prefix+"HoughMaxCurv", Hough.MaxCurv);
+  Hough.NZ0 = parameterSet.getUntrackedParameter<int>(Prefix+"HoughZ0Bins", Hough.NZ0);
+  Hough.MaxZ0 = parameterSet.getUntrackedParameter<double>(Prefix+"HoughMaxZ0", Hough.MaxZ0);
+  Hough.NRZCurv = parameterSet.getUntrackedParameter<int>(Prefix+"HoughRZCurvBins", Hough.NRZCurv);
+  Hough.MaxRZCurv = parameterSet.getUntrackedParameter<double>(Prefix+"HoughMaxRZCurv", Hough.MaxRZCurv);
+  Hough.NSlope = parameterSet.getUntrackedParameter<int>(Prefix+"HoughSlopeBins", Hough.NSlope);
+  Hough.PullCut = parameterSet.getUntrackedParameter<double>(Prefix+"HoughPullCut", Hough.PullCut);
+
+  if(Hough.NPhi < 1 || Hough.NCurv < 1 || Hough.NZ0 < 1 || Hough.NRZCurv < 1 || Hough.NSlope < 1 || Hough.NSectors < 1)
+    throw cms::Exception("Configuration") << "Hough bin and sector counts have to be positive";
+  if(Hough.MinHits < 3)
+    throw cms::Exception("Configuration") << Prefix << "HoughMinHits has to be at least 3 for the fits";
+}
+
+MplTrackerInput::MplTrackerInput(const MplTrackerConfig &) :
+  NEvents(0), NFilledHits(0), NPreFilterTracks(0), NPreFilterSkipped(0), NSkippedHits(0)
+{
+  TransformWatch.Reset();
+}
+
+MplTrackFinder::MplTrackFinder(const ParameterSet& parameterSet, const std::string &Prefix) :
+  _Engine(MplTrackerConfig(parameterSet, Prefix))
+{
+}
+
+void MplTrackFinder::Summary(const MplTrackerWorkspace &W, const MplTrackerInput &In) const {
+  const std::string Text = _Engine.Summary(W);
+  if(!Text.empty()) edm::LogInfo("MplTracker") << Text;
+
+  if(In.NPreFilterTracks == 0 || In.NEvents == 0) return;
+
+  // the skipped hits would have cost what the filled ones did
+  const double PerHit = In.NFilledHits ? In.TransformWatch.CpuTime()/In.NFilledHits : 0;
+  edm::LogInfo("MplTracker") << "Saturation pre-filter over " << In.NEvents << " events: "
+    << In.NPreFilterSkipped << " of " << In.NPreFilterTracks << " tracks above the pt cut not transformed, "
+    << float(In.NSkippedHits)/In.NEvents << " hits/event skipped at " << 1e6*PerHit << " us/hit, saved "
+    << 1000*PerHit*In.NSkippedHits/In.NEvents << " of " << 1000*(In.TransformWatch.CpuTime() + PerHit*In.NSkippedHits)/In.NEvents
+    << " ms/event";
+}
+
+void MplTrackFinder::Process(const Event& event, const EventSetup& setup, MplTrackerInput &In,
+                             MplTrackerWorkspace &W, MplTrackerResult &Result) const {
+  Fill(event, setup, In);
+  _Engine.Process(In.Event, W, Result);
+}
+
+void MplTrackFinder::Fill(const Event& event, const EventSetup& setup, MplTrackerInput &In) const {
+  // norm factors and module frames, shared by all the modules and streams
+  // of the job and only rebuilt when the geometry changes
+  In.GeomTable = Mono::MonoTrackerGeomTable::shared(setup, Config().MeVperADCPixel, Config().MeVperADCStrip);
+
+  event.getByLabel(Config().Source, In.hTracks);
+  event.getByLabel(Config().Source, In.hTrajectories);
+  event.getByLabel(Config().Source, In.hTrajTrackAssociations);
+
+  BuildTrajIndex(In);
+
+  MplTrackEvent &Out = In.Event;
+  Out.Clear();
+  Out.Run = event.id().run();
+  Out.Event = event.id().event();
+
+  const unsigned NTracks = In.hTracks->size();
+  Out.Pt.resize(NTracks);
+  Out.Eta.resize(NTracks);
+  Out.Phi.resize(NTracks);
+  Out.Charge.resize(NTracks);
+
+  for(uint i=0; i<NTracks; i++){
+    const reco::Track &Track = (*In.hTracks)[i];
+    Out.Pt[i] = Track.pt();
+    Out.Eta[i] = Track.eta();
+    Out.Phi[i] = Track.phi();
+    Out.Charge[i] = Track.charge();
+  }
+
+  FillHitCache(In);
+  _Engine.PrepareHits(Out.Hits);
+
+  if(Config().Hough.Enable){
+    FillSatHits(event, In);
+    _Engine.PrepareHits(Out.SatHits);
+  }
+}
+
+void MplTrackFinder::FillSatHits(const Event& event, MplTrackerInput &In) const {
+  const MplHoughConfig &Hough = Config().Hough;
+  MplHitCache &Hits = In.Event.SatHits;
+
+  Hits.Clear();
+
+  for(uint s=0; s<Hough.Sources.size(); s++){
+    edm::Handle<SiStripRecHit2DCollection> hHits;
+    event.getByLabel(edm::InputTag(Hough.Sources[s]), hHits);
+
+    for(SiStripRecHit2DCollection::const_iterator DetIt = hHits->begin(); DetIt != hHits->end(); ++DetIt){
+      const int iDet = In.GeomTable->index(DetIt->detId());
+      if(iDet < 0) continue;
+      const Mono::MonoTrackerGeomTable::Module &Module = In.GeomTable->module(iDet);
+
+      for(SiStripRecHit2DCollection::DetSet::const_iterator HitIt = DetIt->begin(); HitIt != DetIt->end(); ++HitIt){
+        // the cluster first: most hits are not saturated
+        Mono::StripAmplitudes Ampls;
+        Mono::getStripAmplitudes(&*HitIt, Ampls);
+        if(Ampls.type != Mono::StripAmplitudes::kStrip) continue;
+        if(!Hough.Select(Ampls.strips, Ampls.saturated)) continue;
+
+        const unsigned h = Hits.Add();
+
+        LocalPoint LPos = HitIt->localPosition();
+        LocalError LErr = HitIt->localPositionError();
+
+        In.GeomTable->toGlobal(iDet, LPos.x(), LPos.y(), LPos.z(), Hits.X[h], Hits.Y[h], Hits.Z[h]);
+
+        if(LErr.valid()){
+          GlobalError GErr = ErrorFrameTransformer::transform( LErr, Module.det->surface() );
+          Hits.Cxx[h] = GErr.cxx();
+          Hits.Cyx[h] = GErr.cyx();
+          Hits.Cyy[h] = GErr.cyy();
+          Hits.Czz[h] = GErr.czz();
+          Hits.ErrValid[h] = 1;
+        }else{
+          Hits.Cxx[h] = Hits.Cyx[h] = Hits.Cyy[h] = Hits.Czz[h] = 0;
+          Hits.ErrValid[h] = 0;
+        }
+
+        // no track: path length for a straight line from the origin
+        float dx, dy, dz;
+        In.GeomTable->toLocalDirection(iDet, Hits.X[h], Hits.Y[h], Hits.Z[h], dx, dy, dz);
+        Hits.Cosine[h] = dz/sqrt(dx*dx + dy*dy + dz*dz);
+
+        Hits.Strips[h] = Ampls.strips;
+        Hits.SatStrips[h] = Ampls.saturated;
+        Hits.Charge[h] = Ampls.charge;
+
+        Hits.Norm[h] = Module.norm;
+        Hits.NormCharge[h] = Hits.Norm[h] * Hits.Charge[h] * fabs(Hits.Cosine[h]);
+      }
+    }
+  }
+}
+
+void MplTrackFinder::BuildTrajIndex(MplTrackerInput &In) const {
+  In.TrajIndex.assign(In.hTracks->size(), (const Trajectory *)NULL);
+
+  // refitted tracks only, plain track collections have no trajectories
+  if(!In.hTrajTrackAssociations.isValid()) return;
+
+  // one pass over the association map instead of a search per added track
+  for(TrajTrackAssociationCollection::const_iterator it = In.hTrajTrackAssociations->begin(); it != In.hTrajTrackAssociations->end(); ++it){
+    const edm::Ref<std::vector<Trajectory> > TrajRef = it->key;
+    const reco::TrackRef TrackRef = it->val;
+
+    if(TrackRef.id() != In.hTracks.id()) continue;
+    if(TrackRef.key() >= In.TrajIndex.size()) continue;
+
+    In.TrajIndex[TrackRef.key()] = TrajRef.get();
+  }
+}
+
+void MplTrackFinder::FillHitCache(MplTrackerInput &In) const {
+  MplHitCache &Hits = In.Event.Hits;
+  const bool HaveTraj = In.hTrajTrackAssociations.isValid();
+
+  // with the saturation filter, and no hit output that needs every track,
+  // a track failing it is dropped before any geometry: its hit range stays
+  // empty and the engine does not seed from it
+  const bool PreFilter = Config().SatFilter && !Config().TrackHitOutput;
+
+  Hits.Clear();
+  Hits.TrackBegin.assign(In.hTracks->size()+1, 0);
+
+  In.NEvents++;
+
+  for(uint iTrack=0; iTrack<In.hTracks->size(); iTrack++){
+    Hits.TrackBegin[iTrack] = Hits.NHits();
+
+    const reco::Track &Track = (*In.hTracks)[iTrack];
+    if(Track.pt() < Config().PtCut) continue;
+
+    // valid hits on known modules and their clusters, no geometry needed
+    In.TrackHits.clear();
+    In.TrackDets.clear();
+    In.TrackAmpls.clear();
+    int Strips = 0, SatStrips = 0;
+
+    for (trackingRecHit_iterator iHit=Track.recHitsBegin(); iHit!=Track.recHitsEnd(); iHit++){
+      TrackingRecHitRef Ref = *iHit;
+
+      const TrackingRecHit *Hit = &(*Ref);
+
+      if(!Hit->isValid()) continue;
+
+      const int iDet = In.GeomTable->index(Hit->geographicalId().rawId());
+      if(iDet < 0){
+        edm::LogWarning("MplTracker") << "Hit on unknown module " << Hit->geographicalId().rawId() << " skipped.";
+        continue;
+      }
+
+      // add the dedx information
+      In.TrackAmpls.push_back(Mono::StripAmplitudes());
+      Mono::getStripAmplitudes(Hit, In.TrackAmpls.back());
+      Strips += In.TrackAmpls.back().strips;
+      SatStrips += In.TrackAmpls.back().saturated;
+
+      In.TrackHits.push_back(Hit);
+      In.TrackDets.push_back(iDet);
+    }
+
+    if(PreFilter){
+      In.NPreFilterTracks++;
+      if(!Config().SatSelect(Strips, SatStrips)){
+        In.NPreFilterSkipped++;
+        In.NSkippedHits += In.TrackHits.size();
+        continue;
+      }
+    }
+
+    const Trajectory *Traj = In.TrajIndex[iTrack];
+    if(Traj == NULL && HaveTraj)
+      edm::LogWarning("MplTracker") << "No trajectory associated to track " << iTrack << ", using the track momentum for the path length.";
+
+    In.TransformWatch.Start(kFALSE);
+
+    for(unsigned i=0; i<In.TrackHits.size(); i++){
+      const TrackingRecHit *Hit = In.TrackHits[i];
+      const int iDet = In.TrackDets[i];
+      const Mono::StripAmplitudes &Ampls = In.TrackAmpls[i];
+
+      const Mono::MonoTrackerGeomTable::Module &Module = In.GeomTable->module(iDet);
+      const GeomDet *Detector = Module.det;
+
+      const unsigned h = Hits.Add();
+
+      LocalPoint LPos = Hit->localPosition();
+      LocalError LErr = Hit->localPositionError();
+
+      In.GeomTable->toGlobal(iDet, LPos.x(), LPos.y(), LPos.z(), Hits.X[h], Hits.Y[h], Hits.Z[h]);
+
+      // raw errors, the engine derives the fit errors from them
+      if(LErr.valid()){
+        GlobalError GErr = ErrorFrameTransformer::transform( LErr, Detector->surface() );
+        Hits.Cxx[h] = GErr.cxx();
+        Hits.Cyx[h] = GErr.cyx();
+        Hits.Cyy[h] = GErr.cyy();
+        Hits.Czz[h] = GErr.czz();
+        Hits.ErrValid[h] = 1;
+      }else{
+        Hits.Cxx[h] = Hits.Cyx[h] = Hits.Cyy[h] = Hits.Czz[h] = 0;
+        Hits.ErrValid[h] = 0;
+      }
+
+      // path length through the module
+      if(Traj){
+        TrajectoryStateOnSurface State(Traj->geometricalInnermostState().globalParameters(), Detector->surface());
+        LocalVector Direction = State.localDirection();
+        Hits.Cosine[h] = Direction.z()/Direction.mag();
+      }else{
+        float dx, dy, dz;
+        In.GeomTable->toLocalDirection(iDet, Track.px(), Track.py(), Track.pz(), dx, dy, dz);
+        Hits.Cosine[h] = dz/sqrt(dx*dx + dy*dy + dz*dz);
+      }
+
+      // don't use pixels for now (since the standard algorithms don't use them)
+      const float Charge = Ampls.type == Mono::StripAmplitudes::kPixel ? -1 : Ampls.charge;
+
+      Hits.Strips[h] = Ampls.strips;
+      Hits.SatStrips[h] = Ampls.saturated;
+      Hits.Charge[h] = Charge;
+
+      Hits.Norm[h] = Module.norm;
+      Hits.NormCharge[h] = Hits.Norm[h] * Charge * fabs(Hits.Cosine[h]);
+    }
+
+    In.TransformWatch.Stop();
+    In.NFilledHits += In.TrackHits.size();
+  }
+
+  Hits.TrackBegin[In.hTracks->size()] = Hits.NHits();
+}
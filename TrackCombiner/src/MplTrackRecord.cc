@@ -0,0 +1,40 @@
+#include "Monopoles/TrackCombiner/interface/MplTrackRecord.h"
+#include "Monopoles/TrackCombiner/interface/MplTrackEngine.h"
+
+MplTrackRecord::MplTrackRecord() :
+  Finder(0), GroupBegin(0), GroupSize(0),
+  Chi2XY(0), Chi2RZ(0), Ndof(0), Iso(0),
+  Hits(0), SatHits(0), SubHits(0), SatSubHits(0)
+{
+  for(int i=0; i<3; i++) XYPar[i] = XYErr[i] = RZPar[i] = RZErr[i] = 0;
+  for(int i=0; i<MplDeDxEstimator::kNEstimators; i++) DeDx[i] = 0;
+  for(int i=0; i<fNEcalClustID; i++){
+    ClustMatch[i] = -1;
+    ClustDist[i] = 999;
+  }
+}
+
+void MplTrackRecord::Fill(const MplTrackSet &Set, int Begin){
+  Finder = Set.Finder;
+  GroupBegin = Begin;
+  GroupSize = Set.Group.size();
+
+  for(int i=0; i<3; i++){
+    XYPar[i] = Set.XYPar[i];
+    XYErr[i] = Set.XYErr[i];
+    RZPar[i] = Set.RZPar[i];
+    RZErr[i] = Set.RZErr[i];
+  }
+
+  Chi2XY = Set.Chi2XY;
+  Chi2RZ = Set.Chi2RZ;
+  Ndof = Set.Ndof;
+  Iso = Set.Iso;
+
+  Hits = Set.Hits;
+  SatHits = Set.SatHits;
+  SubHits = Set.SubHits;
+  SatSubHits = Set.SatSubHits;
+
+  for(int i=0; i<MplDeDxEstimator::kNEstimators; i++) DeDx[i] = Set.DeDx[i];
+}
@@ -0,0 +1,9 @@
+#include "Monopoles/TrackCombiner/interface/MplTrackRecord.h"
+
+#include <vector>
+
+namespace {
+  struct dictionary {
+    std::vector<MplTrackRecord> vRecords;
+  };
+}
@@ -0,0 +1,212 @@
+///////////////////////////////////////////////
+// Write the same toy events with the dumper's
+// branch types (leaf lists, vectors of basic
+// types and strings, the split "Track" branch
+// of MplTrackRecord) through MonoAsyncTreeWriter
+// synchronously and on a writer thread, then
+// check the files hold byte-identical baskets
+// for every branch and sub-branch.  The event
+// side refills its values right after fill(),
+// as the dumper does.
+//   mplAsyncWriterTest [nEvents] [outDir]
+///////////////////////////////////////////////
+
+#include <vector>
+#include <string>
+#include <sstream>
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+
+#include "Monopoles/MonoAlgorithms/interface/MonoAsyncTreeWriter.h"
+#include "Monopoles/TrackCombiner/interface/MplTrackRecord.h"
+
+#include "Cintex/Cintex.h"
+#include "TFile.h"
+#include "TTree.h"
+#include "TBranch.h"
+#include "TBasket.h"
+#include "TBuffer.h"
+#include "TLeaf.h"
+#include "TObjArray.h"
+
+
+double uniform(double lo, double hi) { return lo + (hi-lo)*(rand()+0.5)/(RAND_MAX+1.); }
+
+struct Event {
+  unsigned run;
+  double weight;
+  int nVtx;
+  bool passed;
+  ULong64_t id;
+  std::vector<double> eta;
+  std::vector<int> seed;
+  std::vector<bool> trig;
+  std::vector<std::string> names;
+  std::vector<MplTrackRecord> tracks;
+
+  void branch(TTree *tree) {
+    tree->Branch("run", &run, "run/i");
+    tree->Branch("weight", &weight, "weight/D");
+    tree->Branch("nVtx", &nVtx, "nVtx/I");
+    tree->Branch("passed", &passed, "passed/O");
+    tree->Branch("id", &id, "id/l");
+    tree->Branch("eta", &eta);
+    tree->Branch("seed", &seed);
+    tree->Branch("trig", &trig);
+    tree->Branch("names", &names);
+    tree->Branch("Track", &tracks, 32000, 99);
+  }
+
+  // the same values for an event number whatever was filled before
+  void fill(unsigned e) {
+    srand(4357 + e);
+    run = 190000 + e/100;
+    weight = uniform(0.,2.);
+    nVtx = rand()%30;
+    passed = rand()%2;
+    id = 1000000000000ULL + e;
+
+    const unsigned n = rand()%20;
+    eta.resize(n);
+    seed.resize(n);
+    trig.resize(n);
+    names.resize(n);
+    for ( unsigned i=0; i != n; i++ ) {
+      eta[i] = uniform(-2.5,2.5);
+      seed[i] = rand()%1000;
+      trig[i] = rand()%3 == 0;
+      std::ostringstream name;
+      name << "HLT_Path" << rand()%50 << "_v" << rand()%5;
+      names[i] = name.str();
+    }
+
+    tracks.resize(rand()%5);
+    for ( unsigned i=0; i != tracks.size(); i++ ) {
+      MplTrackRecord &t = tracks[i];
+      t = MplTrackRecord();
+      t.Finder = rand()%2;
+      t.GroupBegin = rand()%10;
+      t.GroupSize = 1 + rand()%3;
+      for ( int k=0; k != 3; k++ ) {
+        t.XYPar[k] = uniform(-1.,1.); t.XYErr[k] = uniform(0.,0.1);
+        t.RZPar[k] = uniform(-1.,1.); t.RZErr[k] = uniform(0.,0.1);
+      }
+      t.Chi2XY = uniform(0.,10.);
+      t.Chi2RZ = uniform(0.,10.);
+      t.Ndof = rand()%20;
+      t.Iso = uniform(0.,5.);
+      t.Hits = rand()%30; t.SatHits = rand()%10;
+      t.SubHits = rand()%300; t.SatSubHits = rand()%100;
+      for ( int k=0; k != MplDeDxEstimator::kNEstimators; k++ ) t.DeDx[k] = uniform(0.,20.);
+      for ( int k=0; k != fNEcalClustID; k++ ) { t.ClustMatch[k] = rand()%10 - 1; t.ClustDist[k] = uniform(0.,1.); }
+    }
+  }
+};
+
+void write(const std::string &fileName, unsigned depth, unsigned nEvents)
+{
+  Event ev;
+  TFile file(fileName.c_str(), "recreate");
+  TTree *tree = new TTree("tree", "tree");
+  ev.branch(tree);
+
+  Mono::MonoAsyncTreeWriter writer(depth);
+  writer.bind<std::vector<MplTrackRecord> >("Track");
+  writer.start(tree);
+  for ( unsigned e=0; e != nEvents; e++ ) {
+    ev.fill(e);
+    writer.fill();
+  }
+  writer.stop();
+
+  file.cd();
+  tree->FlushBaskets();
+  tree->Write();
+  std::cout << fileName << ": depth " << depth << ", " << writer.entries() << " entries, "
+            << writer.writeTime() << " s filling, " << writer.stallTime() << " s stalled" << std::endl;
+  file.Close();
+}
+
+// every branch that holds data, sub-branches of split objects included
+void leafBranches(TTree *tree, std::vector<TBranch *> &branches)
+{
+  TObjArray *leaves = tree->GetListOfLeaves();
+  for ( int i=0; i != leaves->GetEntries(); i++ ) {
+    TBranch *branch = ((TLeaf*)leaves->At(i))->GetBranch();
+    if ( branches.empty() || branches.back() != branch ) branches.push_back(branch);
+  }
+}
+
+// the data bytes of all baskets of two branches, without the key headers
+void compareBaskets(TBranch *a, TBranch *b)
+{
+  assert( std::string(a->GetName()) == b->GetName() );
+  assert( a->GetEntries() == b->GetEntries() );
+  assert( a->GetTotBytes() == b->GetTotBytes() );
+  assert( a->GetWriteBasket() == b->GetWriteBasket() );
+
+  for ( int i=0; i != a->GetWriteBasket(); i++ ) {
+    TBasket *ba = a->GetBasket(i);
+    TBasket *bb = b->GetBasket(i);
+    assert( ba && bb );
+    assert( ba->GetNevBuf() == bb->GetNevBuf() );
+    assert( ba->GetKeylen() == bb->GetKeylen() && ba->GetLast() == bb->GetLast() );
+    const int begin = ba->GetKeylen();
+    assert( memcmp(ba->GetBufferRef()->Buffer() + begin, bb->GetBufferRef()->Buffer() + begin, ba->GetLast() - begin) == 0 );
+  }
+}
+
+
+int main(int argc, char **argv) {
+
+  const unsigned nEvents = argc > 1 ? atoi(argv[1]) : 20000;
+  const std::string outDir = argc > 2 ? argv[2] : ".";
+
+  ROOT::Cintex::Cintex::Enable();
+
+  const unsigned depths[3] = {0, 1, 8};
+  std::vector<std::string> files;
+  for ( unsigned d=0; d != 3; d++ ) {
+    std::ostringstream name;
+    name << outDir << "/mplAsyncWriterTest_" << depths[d] << ".root";
+    files.push_back(name.str());
+    write(files.back(), depths[d], nEvents);
+  }
+
+  TFile syncFile(files[0].c_str());
+  TTree *syncTree = (TTree*)syncFile.Get("tree");
+  std::vector<TBranch *> syncBranches;
+  leafBranches(syncTree, syncBranches);
+  assert( syncTree->GetEntries() == (Long64_t)nEvents );
+
+  for ( unsigned d=1; d != 3; d++ ) {
+    TFile asyncFile(files[d].c_str());
+    TTree *asyncTree = (TTree*)asyncFile.Get("tree");
+    std::vector<TBranch *> asyncBranches;
+    leafBranches(asyncTree, asyncBranches);
+
+    assert( asyncTree->GetEntries() == syncTree->GetEntries() );
+    assert( asyncBranches.size() == syncBranches.size() );
+    for ( unsigned b=0; b != syncBranches.size(); b++ ) compareBaskets(syncBranches[b], asyncBranches[b]);
+
+    // and the split records read back as written
+    std::vector<MplTrackRecord> *tracks = 0;
+    asyncTree->SetBranchAddress("Track", &tracks);
+    Event ev;
+    for ( unsigned e=0; e != nEvents; e++ ) {
+      asyncTree->GetEntry(e);
+      ev.fill(e);
+      assert( tracks->size() == ev.tracks.size() );
+      for ( unsigned i=0; i != tracks->size(); i++ )
+        assert( memcmp(&(*tracks)[i], &ev.tracks[i], sizeof(MplTrackRecord)) == 0 );
+    }
+    asyncTree->ResetBranchAddresses();
+    delete tracks;
+
+    std::cout << files[d] << ": " << syncBranches.size() << " branches byte-identical to " << files[0] << std::endl;
+  }
+
+  return 0;
+}
@@ -0,0 +1,88 @@
+///////////////////////////////////////////////
+// Check the MplDeDxEstimator order statistics
+// against sorted copies, and the Landau MPV on
+// Moyal-distributed toy charges of known MPV.
+//   mplDeDxTest [nCandidates]
+///////////////////////////////////////////////
+
+#include <vector>
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+
+#include "Monopoles/TrackCombiner/interface/MplDeDx.h"
+
+
+double uniform(double lo, double hi) { return lo + (hi-lo)*(rand()+0.5)/(RAND_MAX+1.); }
+
+double gaus(double sigma) { return sigma*sqrt(-2*log(uniform(0.,1.)))*cos(2*M_PI*uniform(0.,1.)); }
+
+// -log(z^2) of a unit gaussian z follows the Moyal density with MPV 0
+double moyal(double mpv, double width) { const double z = gaus(1.); return mpv - width*log(z*z); }
+
+
+int main(int argc, char **argv) {
+
+  const unsigned nCandidates = argc > 1 ? atoi(argv[1]) : 10000;
+  const float truncation = 0.4;
+
+  srand(4357);
+
+  MplDeDxEstimator estimator(truncation);
+  const unsigned all = (1 << MplDeDxEstimator::kNEstimators) - 1;
+
+  for ( unsigned c=0; c != nCandidates; c++ ) {
+    const unsigned n = rand()%40;
+    std::vector<float> sorted;
+
+    estimator.Clear();
+    for ( unsigned i=0; i != n; i++ ) {
+      // pixels and unread clusters come with charges <= 0
+      const float q = rand()%8 == 0 ? -1 : moyal(3.,0.3);
+      estimator.Add(q);
+      if ( q > 0 ) sorted.push_back(q);
+    }
+    std::sort(sorted.begin(), sorted.end());
+    assert( estimator.N() == sorted.size() );
+
+    float values[MplDeDxEstimator::kNEstimators];
+    estimator.Compute(all, values);
+
+    if ( sorted.empty() ) {
+      for ( unsigned e=0; e != MplDeDxEstimator::kNEstimators; e++ ) assert( values[e] == 0 );
+      continue;
+    }
+
+    const unsigned m = sorted.size();
+    assert( values[MplDeDxEstimator::kMedian] == sorted[m/2] );
+
+    unsigned keep = (unsigned)(m*(1-truncation) + 0.5);
+    keep = std::max(1u, std::min(keep, m));
+    double sum = 0, harm = 0;
+    for ( unsigned i=0; i != keep; i++ ) sum += sorted[i];
+    for ( unsigned i=0; i != m; i++ ) harm += 1./(sorted[i]*sorted[i]);
+    assert( fabs(values[MplDeDxEstimator::kTruncatedMean] - sum/keep) < 1e-5*sum/keep );
+    assert( fabs(values[MplDeDxEstimator::kHarmonic2] - 1./sqrt(harm/m)) < 1e-5/sqrt(harm/m) );
+
+    assert( values[MplDeDxEstimator::kLandauMPV] >= sorted[0] && values[MplDeDxEstimator::kLandauMPV] <= sorted[m-1] );
+  }
+
+  // MPV of large samples: unbiased within a few percent of the width
+  const double mpv = 5., width = 0.5;
+  double sumMPV = 0;
+  const unsigned nSamples = 200;
+  for ( unsigned s=0; s != nSamples; s++ ) {
+    estimator.Clear();
+    for ( unsigned i=0; i != 500; i++ ) estimator.Add(moyal(mpv,width));
+    sumMPV += estimator.LandauMPV();
+  }
+  const double meanMPV = sumMPV/nSamples;
+  std::cout << "MPV " << mpv << " width " << width << ": fitted " << meanMPV << std::endl;
+  assert( fabs(meanMPV - mpv) < 0.05*width );
+
+  std::cout << nCandidates << " candidates, estimators agree with the sorted references" << std::endl;
+
+  return 0;
+}
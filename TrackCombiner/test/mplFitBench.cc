@@ -0,0 +1,118 @@
+///////////////////////////////////////////////
+// Compare the closed-form MplFit fitters with the
+// TGraphErrors+TF1 fits they replace on toy monopole
+// tracks: parameter agreement and time per fit.
+// The XY radius goes from 500 cm to straight lines,
+// with the analytic chi2/ndof checked per decade.
+//   mplFitBench [nTracks] [hitsPerTrack]
+///////////////////////////////////////////////
+
+#include <vector>
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <cmath>
+
+#include "Monopoles/TrackCombiner/interface/MplFitter.h"
+
+#include "TGraphErrors.h"
+#include "TF1.h"
+#include "TFitResult.h"
+#include "TFitResultPtr.h"
+#include "TRandom3.h"
+#include "TStopwatch.h"
+
+
+int main(int argc, char **argv) {
+
+  const unsigned nTracks = argc > 1 ? atoi(argv[1]) : 2000;
+  const unsigned nHits = argc > 2 ? atoi(argv[2]) : 20;
+
+  TF1 RZFunc("RZFunc", "[0] + [1]*x + [2]*x^2", 0, 200);
+  TF1 XYFunc("XYFunc", "[0] + sqrt([2]^2 - (x-[1])^2)*TMath::Sign(1,[2]) - [2]", 0, 200);
+
+  TRandom3 rand(4357);
+  TStopwatch analyticWatch, rootWatch;
+  analyticWatch.Reset();
+  rootWatch.Reset();
+
+  std::vector<double> r(nHits), z(nHits), er(nHits), ez(nHits);
+  std::vector<double> x(nHits), y(nHits), ex(nHits), ey(nHits);
+
+  double maxPullRZ = 0, maxPullXY = 0;
+
+  // XY chi2/ndof per decade of radius from 500 cm, the last for straight lines
+  const unsigned nDecades = 5;
+  double chi2XY[nDecades+1] = {0}, nXY[nDecades+1] = {0};
+
+  for ( unsigned t=0; t != nTracks; t++ ) {
+
+    // monopoles bend in RZ (parabola) and only slightly in XY
+    const double p1 = rand.Uniform(-2.,2.);
+    const double p2 = rand.Uniform(-2e-3,2e-3);
+    // up to 5e7 cm log-uniform, one in six straight
+    const bool straight = rand.Rndm() < 1./6;
+    const double decades = rand.Uniform(0.,nDecades);
+    const double radius = (rand.Rndm() > 0.5 ? 1. : -1.)*500.*pow(10.,decades);
+
+    for ( unsigned i=0; i != nHits; i++ ) {
+      r[i] = 4. + 105.*i/(nHits-1);
+      er[i] = 0.05;
+      ez[i] = i < 3 ? 0.01 : 3.;
+      z[i] = p1*r[i] + p2*r[i]*r[i] + rand.Gaus(0.,ez[i]);
+
+      x[i] = r[i];
+      ex[i] = 0.02;
+      ey[i] = 0.02;
+      // sagitta as x^2/(R + sqrt(R^2 - x^2)), exact at large R
+      y[i] = straight ? 0. : x[i]*x[i]/(radius + (radius > 0 ? 1. : -1.)*sqrt(radius*radius - x[i]*x[i]));
+      y[i] = -y[i] + rand.Gaus(0.,ey[i]);
+    }
+
+    MplFitResult rzA, xyA;
+    analyticWatch.Start(kFALSE);
+    MplFit::FitParabola(nHits,&r[0],&z[0],&er[0],&ez[0],rzA);
+    MplFit::FitCircle(nHits,&x[0],&y[0],&ex[0],&ey[0],xyA);
+    analyticWatch.Stop();
+
+    rootWatch.Start(kFALSE);
+    TGraphErrors rzGraph(nHits,&r[0],&z[0],&er[0],&ez[0]);
+    RZFunc.SetParameters(0,0,0);
+    TFitResultPtr rzR = rzGraph.Fit(&RZFunc,"Q S N");
+    TGraphErrors xyGraph(nHits,&x[0],&y[0],&ex[0],&ey[0]);
+    XYFunc.SetParameters(1,1,straight ? MplFit::MaxRadius : radius);
+    TFitResultPtr xyR = xyGraph.Fit(&XYFunc,"Q S B N");
+    rootWatch.Stop();
+
+    assert( rzA.Valid && xyA.Valid );
+    assert( xyA.Chi2 == xyA.Chi2 && xyA.Par[1] == xyA.Par[1] && xyA.Par[2] != 0 );
+    const unsigned bin = straight ? nDecades : unsigned(decades);
+    chi2XY[bin] += xyA.Chi2/xyA.Ndof;
+    nXY[bin]++;
+    for ( unsigned p=0; p != 3; p++ ) {
+      if ( rzR->ParError(p) > 0 )
+        maxPullRZ = std::max(maxPullRZ,fabs(rzA.Par[p]-rzR->Parameter(p))/rzR->ParError(p));
+      if ( xyR->ParError(p) > 0 )
+        maxPullXY = std::max(maxPullXY,fabs(xyA.Par[p]-xyR->Parameter(p))/xyR->ParError(p));
+    }
+  }
+
+  const double tA = 1e6*analyticWatch.CpuTime()/nTracks;
+  const double tR = 1e6*rootWatch.CpuTime()/nTracks;
+
+  std::cout << "tracks: " << nTracks << " hits/track: " << nHits << std::endl;
+  std::cout << "analytic RZ+XY: " << tA << " us/track" << std::endl;
+  std::cout << "ROOT RZ+XY:     " << tR << " us/track" << std::endl;
+  std::cout << "speedup:        " << (tA > 0 ? tR/tA : 0) << std::endl;
+  std::cout << "max |analytic-ROOT|/err RZ: " << maxPullRZ << " XY: " << maxPullXY << std::endl;
+  for ( unsigned b=0; b <= nDecades; b++ ) {
+    if ( nXY[b] == 0 ) continue;
+    if ( b < nDecades ) std::cout << "XY chi2/ndof R " << 500.*pow(10.,b) << "-" << 500.*pow(10.,b+1) << " cm: ";
+    else std::cout << "XY chi2/ndof straight:  ";
+    std::cout << chi2XY[b]/nXY[b] << " over " << nXY[b] << " tracks" << std::endl;
+    // gaussian errors: about 1 whatever the radius
+    assert( chi2XY[b]/nXY[b] < 1.5 );
+  }
+
+  return 0;
+}
@@ -0,0 +1,104 @@
+///////////////////////////////////////////////
+// Compare the XY chi2 of the running MplFitMoments
+// sums, which AddMoreTracks cuts on, with that of
+// the full MplFit::FitCircle fit on toy tracks from
+// R = 500 cm up to straight lines, at any azimuth,
+// and check the chi2/ndof of both stays near 1.
+// Exactly collinear hits must give a line chi2,
+// not the old "accept" of a singular system.
+//   mplFitMomentsTest [nTracks] [hitsPerTrack]
+///////////////////////////////////////////////
+
+#include <vector>
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <cmath>
+
+#include "Monopoles/TrackCombiner/interface/MplFitter.h"
+
+
+double uniform(double lo, double hi) { return lo + (hi-lo)*(rand()+0.5)/(RAND_MAX+1.); }
+
+double gaus(double sigma) { return sigma*sqrt(-2*log(uniform(0.,1.)))*cos(2*M_PI*uniform(0.,1.)); }
+
+// hits of a track from near the beam line with direction phi, bending
+// with signed radius R (0 for a straight line), at radii 4-108 cm
+void makeTrack(double phi, double radius, double sigma, unsigned nHits,
+               std::vector<double> &x, std::vector<double> &y, std::vector<double> &e)
+{
+  const double d0 = gaus(0.01);
+  x.resize(nHits);
+  y.resize(nHits);
+  e.assign(nHits,sigma);
+  for ( unsigned i=0; i != nHits; i++ ) {
+    const double s = 4. + 104.*i/(nHits-1);
+    // along the track and across it, the sagitta exact at large R
+    const double v = radius == 0 ? 0. : s*s/(radius + (radius > 0 ? 1. : -1.)*sqrt(radius*radius - s*s));
+    x[i] = s*cos(phi) - (v + d0)*sin(phi) + gaus(sigma);
+    y[i] = s*sin(phi) + (v + d0)*cos(phi) + gaus(sigma);
+  }
+}
+
+
+int main(int argc, char **argv) {
+
+  const unsigned nTracks = argc > 1 ? atoi(argv[1]) : 500;
+  const unsigned nHits = argc > 2 ? atoi(argv[2]) : 14;
+
+  srand(4357);
+
+  // 30 and 200 um errors; radii in cm, 0 is straight
+  const double sigmas[2] = {30e-4, 200e-4};
+  const double radii[7] = {500., 2000., 1e4, 3e4, 1e5, 1e6, 0.};
+
+  std::vector<double> x, y, e;
+  double maxRelDiff = 0.;
+
+  for ( unsigned s=0; s != 2; s++ ) {
+    for ( unsigned r=0; r != 7; r++ ) {
+      double sumMoments = 0., sumFit = 0.;
+
+      for ( unsigned t=0; t != nTracks; t++ ) {
+        const double radius = (rand()%2 ? 1. : -1.)*radii[r];
+        makeTrack(uniform(-M_PI,M_PI),radius,sigmas[s],nHits,x,y,e);
+
+        MplFitMoments moments;
+        moments.Reset();
+        for ( unsigned i=0; i != nHits; i++ ) moments.Add(x[i],y[i],1/(e[i]*e[i]),0.,1.);
+
+        MplFitResult fit;
+        MplFit::FitCircle(nHits,&x[0],&y[0],&e[0],&e[0],fit);
+        assert( fit.Valid );
+
+        // the algebraic chi2 is the geometric one to O(L/R)
+        const double chi2 = moments.Chi2XY();
+        const double relDiff = std::fabs(chi2 - fit.Chi2)/(fit.Chi2 + 1.);
+        assert( relDiff < 0.01 );
+        if ( relDiff > maxRelDiff ) maxRelDiff = relDiff;
+
+        sumMoments += chi2;
+        sumFit += fit.Chi2;
+      }
+
+      const double ndof = nHits - 3;
+      std::cout << "sigma " << 1e4*sigmas[s] << " um, R " << (radii[r] > 0 ? radii[r] : HUGE_VAL)
+                << " cm: chi2/ndof moments " << sumMoments/nTracks/ndof << " fit " << sumFit/nTracks/ndof << std::endl;
+      assert( std::fabs(sumMoments/nTracks/ndof - 1.) < 0.2 );
+      assert( std::fabs(sumFit/nTracks/ndof - 1.) < 0.2 );
+    }
+  }
+
+  // exactly collinear hits: a line chi2 of zero, and a hit off the line
+  // by five sigma shows up in it
+  MplFitMoments line;
+  line.Reset();
+  for ( unsigned i=0; i != nHits; i++ ) line.Add(10. + 7.*i, -3. - 4.*i, 1e4, 0., 1.);
+  assert( line.Chi2XY() < 1e-6 );
+  line.Add(10. + 7.*nHits + 0.03, -3. - 4.*nHits + 0.04, 1e4, 0., 1.);
+  assert( line.Chi2XY() > 10. );
+
+  std::cout << "max |moments-fit|/(fit+1): " << maxRelDiff << std::endl;
+
+  return 0;
+}
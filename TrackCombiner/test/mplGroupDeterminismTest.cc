@@ -0,0 +1,132 @@
+///////////////////////////////////////////////
+// Check that MplGroupBuilder gives the same
+// groups, hit lists and fit sums on any number
+// of threads as on one, on toy events with a
+// few monopole-like tracks among many others.
+//   mplGroupDeterminismTest [nEvents] [nTracks]
+///////////////////////////////////////////////
+
+#include <vector>
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+
+#include "tbb/task_scheduler_init.h"
+
+#include "Monopoles/TrackCombiner/interface/MplGroupBuilder.h"
+
+
+double uniform(double lo, double hi) { return lo + (hi-lo)*(rand()+0.5)/(RAND_MAX+1.); }
+
+double gaus(double sigma) { return sigma*sqrt(-2*log(uniform(0.,1.)))*cos(2*M_PI*uniform(0.,1.)); }
+
+bool sameMoments(const MplFitMoments &a, const MplFitMoments &b)
+{
+  return memcmp(a.SR,b.SR,sizeof(a.SR)) == 0 && memcmp(a.SZR,b.SZR,sizeof(a.SZR)) == 0
+    && a.SZZ == b.SZZ && a.X0 == b.X0 && a.Y0 == b.Y0 && a.Cos0 == b.Cos0 && a.Sin0 == b.Sin0
+    && a.Sw == b.Sw && a.Su == b.Su && a.Sv == b.Sv && a.Suu == b.Suu && a.Suv == b.Suv
+    && a.Svv == b.Svv && a.Sq == b.Sq && a.Squ == b.Squ && a.Sqv == b.Sqv && a.Sqq == b.Sqq
+    && a.N == b.N;
+}
+
+
+// hits of one toy track: a parabola in RZ and a circle in XY
+void addTrack(MplHitCache &cache, double phi, double slope, double curv, double radius)
+{
+  const unsigned nHits = 8 + rand()%12;
+  for ( unsigned i=0; i != nHits; i++ ) {
+    const double r = 4. + 105.*i/(nHits-1);
+    const double dphi = asin(std::min(1.,r/(2*radius)));
+    const unsigned h = cache.Add();
+
+    cache.X[h] = r*cos(phi+dphi) + gaus(0.02);
+    cache.Y[h] = r*sin(phi+dphi) + gaus(0.02);
+    cache.Z[h] = slope*r + curv*r*r + gaus(0.05);
+
+    cache.FitCxx[h] = cache.FitCyy[h] = 0.02*0.02 + 4e-4*r*r*1e-3;
+    cache.FitCyx[h] = 0;
+    cache.FitCzz[h] = 0.05*0.05;
+    cache.Strips[h] = 3;
+    cache.SatStrips[h] = 0;
+    // a few low charge hits dropped, a few saturated cores only fitted
+    cache.Fit[h] = uniform(0.,1.) > 0.05;
+    cache.Use[h] = cache.Fit[h] && uniform(0.,1.) > 0.05;
+  }
+}
+
+
+int main(int argc, char **argv) {
+
+  const unsigned nEvents = argc > 1 ? atoi(argv[1]) : 200;
+  const unsigned nTracks = argc > 2 ? atoi(argv[2]) : 300;
+  const float chi2Cut = 5.;
+
+  const int threads[3] = {2, 4, 8};
+
+  srand(4357);
+
+  MplGroupBuilder serial(chi2Cut,1);
+
+  unsigned nGroups = 0, nMerged = 0;
+
+  for ( unsigned e=0; e != nEvents; e++ ) {
+
+    // toy event: monopole pairs are split into several tracks at similar phi
+    MplHitCache cache;
+    cache.TrackBegin.push_back(0);
+    for ( unsigned t=0; t != nTracks; t++ ) {
+      const unsigned mono = rand()%10;
+      const double phi = mono < 2 ? mono*M_PI/2 + gaus(0.01) : uniform(-M_PI,M_PI);
+      const double slope = mono < 2 ? 0.3 : uniform(-2.,2.);
+      const double curv = mono < 2 ? 1e-3 : 0.;
+      addTrack(cache,phi,slope,curv,uniform(100.,5000.));
+      cache.TrackBegin.push_back(cache.NHits());
+    }
+
+    for ( unsigned n=0; n != 3; n++ ) {
+      // the builder runs on the scheduler of its caller
+      tbb::task_scheduler_init scheduler(threads[n]);
+      MplGroupBuilder parallel(chi2Cut,threads[n]);
+      std::vector<bool> usedS(nTracks,false), usedP(nTracks,false);
+
+      for ( unsigned seed=0; seed != nTracks; seed++ ) {
+        if ( usedS[seed] ) continue;
+        assert( !usedP[seed] );
+
+        std::vector<int> candidates;
+        for ( unsigned i=seed+1; i != nTracks; i++ ) candidates.push_back(i);
+
+        MplFitMoments momS, momP;
+        momS.Reset();
+        momP.Reset();
+        std::vector<unsigned> hitsS, hitsP;
+        std::vector<int> groupS(1,seed), groupP(1,seed);
+
+        MplGroupBuilder::AddTrackHits(cache,seed,0.3,momS,&hitsS);
+        MplGroupBuilder::AddTrackHits(cache,seed,0.3,momP,&hitsP);
+
+        serial.AddCandidates(cache,candidates,usedS,0.3,momS,hitsS,groupS);
+        parallel.AddCandidates(cache,candidates,usedP,0.3,momP,hitsP,groupP);
+
+        assert( groupS == groupP );
+        assert( hitsS == hitsP );
+        assert( sameMoments(momS,momP) );
+
+        for ( unsigned j=0; j != groupS.size(); j++ ) usedS[groupS[j]] = usedP[groupP[j]] = true;
+
+        if ( n == 0 ) {
+          nGroups++;
+          if ( groupS.size() > 1 ) nMerged++;
+        }
+      }
+    }
+  }
+
+  std::cout << nEvents << " events, " << nGroups << " groups, " << nMerged << " with more than one track" << std::endl;
+  std::cout << "identical groups for all thread counts" << std::endl;
+
+  return 0;
+}
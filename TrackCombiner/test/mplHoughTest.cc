@@ -0,0 +1,152 @@
+///////////////////////////////////////////////
+// Run the Hough finder of MplTrackEngine on toy
+// events of saturated strip hits: a few monopoles
+// (circle in XY, parabola in RZ) among noise hits.
+// Checks that the monopoles are found with their
+// direction and hits, and that the candidates are
+// the same on any number of threads.
+//   mplHoughTest [nEvents] [nMonopoles] [nNoise] [threads]
+///////////////////////////////////////////////
+
+#include <vector>
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+
+#include "Monopoles/TrackCombiner/interface/MplTrackEngine.h"
+
+
+double uniform(double lo, double hi) { return lo + (hi-lo)*(rand()+0.5)/(RAND_MAX+1.); }
+
+double gaus(double sigma) { return sigma*sqrt(-2*log(uniform(0.,1.)))*cos(2*M_PI*uniform(0.,1.)); }
+
+struct Monopole { double phi, curv, z0, slope, rzCurv; unsigned nHits; };
+
+void addHit(MplHitCache &sat, double x, double y, double z)
+{
+  const unsigned s = sat.Add();
+  sat.X[s] = x + gaus(0.02);
+  sat.Y[s] = y + gaus(0.02);
+  sat.Z[s] = z + gaus(0.05);
+  sat.ErrValid[s] = 1;
+  sat.Cxx[s] = sat.Cyy[s] = 0.02*0.02;
+  sat.Cyx[s] = 0;
+  sat.Czz[s] = 0.05*0.05;
+  sat.Strips[s] = 4 + rand()%20;
+  sat.SatStrips[s] = sat.Strips[s] - rand()%3;
+  sat.NormCharge[s] = sat.Charge[s] = uniform(10.,30.);
+  sat.Norm[s] = sat.Cosine[s] = 1;
+}
+
+// toy event without tracks: monopole hits on the strip layers and noise
+void makeEvent(unsigned event, unsigned nMonopoles, unsigned nNoise, MplTrackEvent &ev, std::vector<Monopole> &truth)
+{
+  ev.Clear();
+  ev.Run = 1;
+  ev.Event = event;
+  truth.clear();
+
+  for ( unsigned m=0; m != nMonopoles; m++ ) {
+    Monopole mpl;
+    mpl.phi = uniform(-M_PI,M_PI);
+    mpl.curv = uniform(-0.003,0.003);
+    mpl.z0 = gaus(5.);
+    mpl.slope = uniform(-1.5,1.5);
+    mpl.rzCurv = uniform(-0.003,0.003);
+    mpl.nHits = 0;
+
+    // barrel strip layers, stop where the parabola leaves the tracker
+    for ( double r = 22.; r < 110.; r += 8. ) {
+      const double z = mpl.z0 + mpl.slope*r + mpl.rzCurv*r*r;
+      if ( fabs(z) > 270. ) break;
+      const double phi = mpl.phi + asin(mpl.curv*r/2);
+      addHit(ev.SatHits, r*cos(phi), r*sin(phi), z);
+      mpl.nHits++;
+    }
+    truth.push_back(mpl);
+  }
+
+  for ( unsigned i=0; i != nNoise; i++ ) {
+    const double r = uniform(20.,110.), phi = uniform(-M_PI,M_PI);
+    addHit(ev.SatHits, r*cos(phi), r*sin(phi), uniform(-270.,270.));
+  }
+}
+
+bool sameSet(const MplTrackSet &a, const MplTrackSet &b)
+{
+  for ( unsigned i=0; i != 3; i++ )
+    if ( a.XYPar[i] != b.XYPar[i] || a.RZPar[i] != b.RZPar[i] ) return false;
+  return a.Finder == b.Finder && a.Hits == b.Hits && a.SatHits == b.SatHits
+    && a.Chi2XY == b.Chi2XY && a.Chi2RZ == b.Chi2RZ && a.Ndof == b.Ndof;
+}
+
+
+int main(int argc, char **argv) {
+
+  const unsigned nEvents = argc > 1 ? atoi(argv[1]) : 200;
+  const unsigned nMonopoles = argc > 2 ? atoi(argv[2]) : 2;
+  const unsigned nNoise = argc > 3 ? atoi(argv[3]) : 200;
+  const int nThreads = argc > 4 ? atoi(argv[4]) : 4;
+
+  MplTrackerConfig config;
+  config.Hough.Enable = true;
+  MplTrackEngine serial(config);
+
+  config.NThreads = nThreads;
+  MplTrackEngine parallel(config);
+
+  MplTrackerWorkspace serialWork(serial.Config()), parallelWork(parallel.Config());
+  MplTrackerResult serialResult, parallelResult;
+
+  srand(4357);
+
+  MplTrackEvent ev;
+  std::vector<Monopole> truth;
+  unsigned nFound = 0, nSets = 0, nFake = 0;
+
+  for ( unsigned e=0; e != nEvents; e++ ) {
+    makeEvent(e, nMonopoles, nNoise, ev, truth);
+    serial.PrepareHits(ev.SatHits);
+
+    serial.Process(ev, serialWork, serialResult);
+    parallel.Process(ev, parallelWork, parallelResult);
+
+    assert( serialResult.Sets.size() == parallelResult.Sets.size() );
+    for ( unsigned s=0; s != serialResult.Sets.size(); s++ ) {
+      assert( serialResult.Sets[s].Finder == MplTrackSet::kHoughFinder );
+      assert( serialResult.Sets[s].Group.empty() );
+      assert( sameSet(serialResult.Sets[s], parallelResult.Sets[s]) );
+    }
+    nSets += serialResult.Sets.size();
+
+    // a monopole is found if a candidate has its RZ trajectory and most of its hits;
+    // the fit errors are ErrorFudge*r, so a noise hit a few cm off can be taken in
+    std::vector<bool> matched(serialResult.Sets.size(), false);
+    for ( unsigned m=0; m != truth.size(); m++ ) {
+      for ( unsigned s=0; s != serialResult.Sets.size(); s++ ) {
+        const MplTrackSet &set = serialResult.Sets[s];
+        if ( matched[s] ) continue;
+        if ( fabs(set.RZPar[0] - truth[m].z0) > 3. || fabs(set.RZPar[1] - truth[m].slope) > 0.1 ) continue;
+        if ( set.Hits < 0.8*truth[m].nHits ) continue;
+        matched[s] = true;
+        nFound++;
+        break;
+      }
+    }
+    nFake += std::count(matched.begin(), matched.end(), false);
+  }
+
+  const double efficiency = double(nFound)/(nEvents*nMonopoles);
+  std::cout << nEvents << " events, " << nMonopoles << " monopoles and " << nNoise << " noise hits each" << std::endl;
+  std::cout << "  found " << nFound << " of " << nEvents*nMonopoles << " (" << 100*efficiency << "%), "
+            << nSets << " candidates, " << nFake << " unmatched" << std::endl;
+  std::cout << serial.Summary(serialWork) << std::endl;
+  std::cout << parallel.Summary(parallelWork) << " (" << nThreads << " threads)" << std::endl;
+
+  assert( efficiency > 0.95 );
+  assert( nFake <= 0.05*nSets );
+
+  return 0;
+}
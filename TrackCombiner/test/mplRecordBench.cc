@@ -0,0 +1,188 @@
+///////////////////////////////////////////////
+// Write the track sets of a replay file with the
+// MplTracker layout (one split "Track" branch of
+// MplTrackRecord plus "Track_Group") and with the
+// old one (a vector branch per field and the group
+// as a csv string), then read both back: file
+// size and time per event of each.
+//   mplRecordBench file [repeat] [outDir]
+///////////////////////////////////////////////
+
+#include <vector>
+#include <string>
+#include <sstream>
+#include <iostream>
+#include <cstdlib>
+
+#include "Monopoles/TrackCombiner/interface/MplTrackEngine.h"
+#include "Monopoles/TrackCombiner/interface/MplTrackRecord.h"
+#include "Monopoles/TrackCombiner/interface/MplReplay.h"
+
+#include "Cintex/Cintex.h"
+#include "TFile.h"
+#include "TTree.h"
+#include "TStopwatch.h"
+
+
+// the branches MplTracker wrote before MplTrackRecord, cluster matches included
+struct OldLayout {
+  std::vector<float> xyPar[3], xyErr[3], rzPar[3], rzErr[3], chi2XY, chi2RZ, ndof, iso;
+  std::vector<float> deDx[MplDeDxEstimator::kNEstimators];
+  std::vector<int> finder, hits, satHits, subHits, satSubHits;
+  std::vector<int> clustMatch[fNEcalClustID];
+  std::vector<double> clustDist[fNEcalClustID];
+  std::vector<std::string> group;
+
+  void branch(TTree *tree) {
+    for ( int i=0; i != 3; i++ ) {
+      std::ostringstream n; n << i;
+      tree->Branch(("Track_XYPar" + n.str()).c_str(), &xyPar[i]);
+      tree->Branch(("Track_XYErr" + n.str()).c_str(), &xyErr[i]);
+      tree->Branch(("Track_RZPar" + n.str()).c_str(), &rzPar[i]);
+      tree->Branch(("Track_RZErr" + n.str()).c_str(), &rzErr[i]);
+    }
+    tree->Branch("Track_Chi2XY", &chi2XY);
+    tree->Branch("Track_Chi2RZ", &chi2RZ);
+    tree->Branch("Track_Ndof", &ndof);
+    tree->Branch("Track_Iso", &iso);
+    for ( int i=0; i != MplDeDxEstimator::kNEstimators; i++ )
+      tree->Branch((std::string("Track_DeDx") + MplDeDxEstimator::Name(i)).c_str(), &deDx[i]);
+    tree->Branch("Track_Finder", &finder);
+    tree->Branch("Track_Hits", &hits);
+    tree->Branch("Track_SatHits", &satHits);
+    tree->Branch("Track_SubHits", &subHits);
+    tree->Branch("Track_SatSubHits", &satSubHits);
+    for ( int i=0; i != fNEcalClustID; i++ ) {
+      std::ostringstream n; n << i;
+      tree->Branch(("Track_clustMatch" + n.str()).c_str(), &clustMatch[i]);
+      tree->Branch(("Track_clustDist" + n.str()).c_str(), &clustDist[i]);
+    }
+    tree->Branch("Track_Group", &group);
+  }
+
+  void fill(const std::vector<MplTrackSet> &sets) {
+    for ( int i=0; i != 3; i++ ) { xyPar[i].clear(); xyErr[i].clear(); rzPar[i].clear(); rzErr[i].clear(); }
+    chi2XY.clear(); chi2RZ.clear(); ndof.clear(); iso.clear();
+    for ( int i=0; i != MplDeDxEstimator::kNEstimators; i++ ) deDx[i].clear();
+    finder.clear(); hits.clear(); satHits.clear(); subHits.clear(); satSubHits.clear();
+    for ( int i=0; i != fNEcalClustID; i++ ) { clustMatch[i].clear(); clustDist[i].clear(); }
+    group.clear();
+
+    for ( unsigned s=0; s != sets.size(); s++ ) {
+      const MplTrackSet &set = sets[s];
+      for ( int i=0; i != 3; i++ ) {
+        xyPar[i].push_back(set.XYPar[i]); xyErr[i].push_back(set.XYErr[i]);
+        rzPar[i].push_back(set.RZPar[i]); rzErr[i].push_back(set.RZErr[i]);
+      }
+      chi2XY.push_back(set.Chi2XY); chi2RZ.push_back(set.Chi2RZ); ndof.push_back(set.Ndof); iso.push_back(set.Iso);
+      for ( int i=0; i != MplDeDxEstimator::kNEstimators; i++ ) deDx[i].push_back(set.DeDx[i]);
+      finder.push_back(set.Finder); hits.push_back(set.Hits); satHits.push_back(set.SatHits);
+      subHits.push_back(set.SubHits); satSubHits.push_back(set.SatSubHits);
+      for ( int i=0; i != fNEcalClustID; i++ ) { clustMatch[i].push_back(-1); clustDist[i].push_back(999); }
+
+      std::ostringstream csv;
+      for ( unsigned i=0; i != set.Group.size(); i++ ) csv << (i ? "," : "") << set.Group[i];
+      group.push_back(csv.str());
+    }
+  }
+};
+
+struct NewLayout {
+  std::vector<MplTrackRecord> records;
+  std::vector<int> group;
+
+  void branch(TTree *tree) {
+    tree->Branch("Track", &records, 32000, 99);
+    tree->Branch("Track_Group", &group);
+  }
+
+  void fill(const std::vector<MplTrackSet> &sets) {
+    records.clear();
+    group.clear();
+    for ( unsigned s=0; s != sets.size(); s++ ) {
+      records.push_back(MplTrackRecord());
+      records.back().Fill(sets[s], group.size());
+      group.insert(group.end(), sets[s].Group.begin(), sets[s].Group.end());
+    }
+  }
+};
+
+template <class Layout>
+void bench(const char *name, const std::string &fileName, const std::vector<MplTrackerResult> &results, unsigned repeat)
+{
+  const unsigned nEvents = repeat*results.size();
+
+  Layout out;
+  TStopwatch writeWatch;
+  writeWatch.Reset();
+  writeWatch.Start(kFALSE);
+  TFile outFile(fileName.c_str(), "recreate");
+  TTree *tree = new TTree("MplTrackSets", "MplTrackSets");
+  out.branch(tree);
+  for ( unsigned r=0; r != repeat; r++ ) {
+    for ( unsigned e=0; e != results.size(); e++ ) {
+      out.fill(results[e].Sets);
+      tree->Fill();
+    }
+  }
+  tree->Write();
+  const Long64_t zipBytes = tree->GetZipBytes(), totBytes = tree->GetTotBytes();
+  outFile.Close();
+  writeWatch.Stop();
+
+  // read and unpack every branch, as an analysis of all track fields
+  // would; without addresses set ROOT makes its own objects
+  TStopwatch readWatch;
+  readWatch.Reset();
+  readWatch.Start(kFALSE);
+  TFile inFile(fileName.c_str());
+  TTree *inTree = (TTree*)inFile.Get("MplTrackSets");
+  Long64_t bytes = 0;
+  for ( Long64_t e=0; e != inTree->GetEntries(); e++ ) bytes += inTree->GetEntry(e);
+  inFile.Close();
+  readWatch.Stop();
+
+  std::cout << name << ": " << zipBytes << " bytes on file (" << totBytes << " uncompressed), "
+            << double(zipBytes)/nEvents << " bytes/event" << std::endl;
+  std::cout << "  write " << 1e6*writeWatch.RealTime()/nEvents << " us/event, "
+            << "read " << 1e6*readWatch.RealTime()/nEvents << " us/event (" << bytes << " bytes)" << std::endl;
+}
+
+
+int main(int argc, char **argv) {
+
+  if ( argc < 2 ) {
+    std::cerr << "usage: " << argv[0] << " file [repeat] [outDir]" << std::endl;
+    return 1;
+  }
+
+  const unsigned repeat = argc > 2 ? atoi(argv[2]) : 10;
+  const std::string outDir = argc > 3 ? argv[3] : ".";
+
+  ROOT::Cintex::Cintex::Enable();
+
+  MplTrackerConfig config;
+  MplTrackEngine engine(config);
+  MplTrackerWorkspace workspace(config);
+
+  // the track sets of every event, so only the output is timed
+  std::vector<MplTrackerResult> results;
+  MplReplayReader reader(argv[1]);
+  MplTrackEvent ev;
+  while ( reader.Read(ev) ) {
+    engine.PrepareHits(ev.Hits);
+    engine.PrepareHits(ev.SatHits);
+    results.push_back(MplTrackerResult());
+    engine.Process(ev, workspace, results.back());
+  }
+  if ( !reader.Good() ) {
+    std::cerr << argv[1] << ": not a replay file or truncated after " << results.size() << " events" << std::endl;
+    return 1;
+  }
+
+  std::cout << results.size() << " events x " << repeat << std::endl;
+  bench<OldLayout>("vector branches", outDir + "/mplRecordBench_old.root", results, repeat);
+  bench<NewLayout>("MplTrackRecord", outDir + "/mplRecordBench_new.root", results, repeat);
+
+  return 0;
+}
@@ -0,0 +1,81 @@
+///////////////////////////////////////////////
+// Run MplTrackEngine over the events of a replay
+// file written by MplReplayDumper: time per event
+// and a summary of the combined tracks.
+//   mplReplayBench file [threads] [repeat] [fitMode] [satFilter]
+// fitMode: 0 analytic, 1 ROOT, 2 validate
+// satFilter: 1 to drop tracks with few saturated strips
+// before grouping, compare with 0 for the time saved
+///////////////////////////////////////////////
+
+#include <vector>
+#include <iostream>
+#include <cstdlib>
+
+#include "Monopoles/TrackCombiner/interface/MplTrackEngine.h"
+#include "Monopoles/TrackCombiner/interface/MplReplay.h"
+
+#include "TStopwatch.h"
+
+
+int main(int argc, char **argv) {
+
+  if ( argc < 2 ) {
+    std::cerr << "usage: " << argv[0] << " file [threads] [repeat] [fitMode] [satFilter]" << std::endl;
+    return 1;
+  }
+
+  MplTrackerConfig config;
+  config.NThreads = argc > 2 ? atoi(argv[2]) : 1;
+  const unsigned repeat = argc > 3 ? atoi(argv[3]) : 1;
+  config.FitMode = argc > 4 ? atoi(argv[4]) : MplTrackerConfig::kAnalyticFit;
+  config.SatFilter = argc > 5 && atoi(argv[5]);
+
+  MplTrackEngine engine(config);
+
+  // read everything first, so only the engine is timed
+  std::vector<MplTrackEvent> events;
+  MplReplayReader reader(argv[1]);
+  MplTrackEvent ev;
+  while ( reader.Read(ev) ) {
+    engine.PrepareHits(ev.Hits);
+    events.push_back(ev);
+  }
+  if ( !reader.Good() ) {
+    std::cerr << argv[1] << ": not a replay file or truncated after " << events.size() << " events" << std::endl;
+    return 1;
+  }
+
+  MplTrackerWorkspace workspace(config);
+  MplTrackerResult result;
+  unsigned nSets = 0, nMerged = 0, nHits = 0;
+
+  TStopwatch watch;
+  watch.Reset();
+  watch.Start(kFALSE);
+  for ( unsigned r=0; r != repeat; r++ ) {
+    for ( unsigned e=0; e != events.size(); e++ ) {
+      engine.Process(events[e], workspace, result);
+      if ( r == 0 ) {
+        nSets += result.Sets.size();
+        for ( unsigned s=0; s != result.Sets.size(); s++ ) {
+          if ( result.Sets[s].Group.size() > 1 ) nMerged++;
+          nHits += result.Sets[s].Hits;
+        }
+      }
+    }
+  }
+  watch.Stop();
+
+  const unsigned nProcessed = repeat*events.size();
+  std::cout << events.size() << " events x " << repeat << ", " << config.NThreads << " thread(s)" << std::endl;
+  std::cout << "  " << nSets << " track sets, " << nMerged << " with more than one track, " << nHits << " hits" << std::endl;
+  if ( nProcessed )
+    std::cout << "  " << 1000*watch.RealTime()/nProcessed << " ms/event real, "
+              << 1000*watch.CpuTime()/nProcessed << " ms/event cpu" << std::endl;
+
+  const std::string summary = engine.Summary(workspace);
+  if ( !summary.empty() ) std::cout << summary << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,210 @@
+///////////////////////////////////////////////
+// Write toy MplTrackEvents to a replay file, read
+// them back and check that the events and the
+// MplTrackEngine results are identical, and that a
+// truncated file is reported.
+//   mplReplayTest [nEvents] [nTracks] [file]
+///////////////////////////////////////////////
+
+#include <vector>
+#include <string>
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <cstdio>
+#include <cmath>
+#include <algorithm>
+
+#include "Monopoles/TrackCombiner/interface/MplTrackEngine.h"
+#include "Monopoles/TrackCombiner/interface/MplReplay.h"
+
+
+double uniform(double lo, double hi) { return lo + (hi-lo)*(rand()+0.5)/(RAND_MAX+1.); }
+
+double gaus(double sigma) { return sigma*sqrt(-2*log(uniform(0.,1.)))*cos(2*M_PI*uniform(0.,1.)); }
+
+
+// toy event: a few monopoles split into several tracks among many others
+void makeEvent(unsigned run, unsigned event, unsigned nTracks, float ptCut, MplTrackEvent &ev)
+{
+  ev.Clear();
+  ev.Run = run;
+  ev.Event = event;
+
+  MplHitCache &hits = ev.Hits;
+  hits.TrackBegin.push_back(0);
+
+  for ( unsigned t=0; t != nTracks; t++ ) {
+    const unsigned mono = rand()%10;
+    const double phi = mono < 2 ? mono*M_PI/2 + gaus(0.01) : uniform(-M_PI,M_PI);
+    const double slope = mono < 2 ? 0.3 : uniform(-2.,2.);
+    const double curv = mono < 2 ? 1e-3 : 0.;
+    const double radius = uniform(100.,5000.);
+
+    ev.Pt.push_back(mono < 2 ? uniform(20.,200.) : uniform(0.5,20.));
+    ev.Eta.push_back(asinh(slope));
+    ev.Phi.push_back(phi);
+    ev.Charge.push_back(rand()%2 ? 1 : -1);
+
+    if ( ev.Pt.back() >= ptCut ) {
+      const unsigned nHits = 8 + rand()%12;
+      for ( unsigned i=0; i != nHits; i++ ) {
+        const double r = 4. + 105.*i/(nHits-1);
+        const double dphi = asin(std::min(1.,r/(2*radius)));
+        const unsigned h = hits.Add();
+
+        hits.X[h] = r*cos(phi+dphi) + gaus(0.02);
+        hits.Y[h] = r*sin(phi+dphi) + gaus(0.02);
+        hits.Z[h] = slope*r + curv*r*r + gaus(0.05);
+
+        hits.ErrValid[h] = rand()%20 != 0;
+        hits.Cxx[h] = hits.Cyy[h] = hits.ErrValid[h] ? 0.02*0.02 : 0;
+        hits.Cyx[h] = 0;
+        hits.Czz[h] = hits.ErrValid[h] ? 0.05*0.05 : 0;
+
+        hits.Strips[h] = mono < 2 ? 10 + rand()%20 : 1 + rand()%5;
+        hits.SatStrips[h] = mono < 2 ? rand()%(hits.Strips[h]+1) : 0;
+        hits.NormCharge[h] = i < 3 ? -1 : mono < 2 ? uniform(10.,30.) : uniform(1.,6.);
+        hits.Charge[h] = hits.NormCharge[h];
+        hits.Norm[h] = hits.Cosine[h] = 1;
+
+        if ( mono < 2 ) {
+          const unsigned s = ev.SatHits.Add();
+          MplHitCache &sat = ev.SatHits;
+          sat.X[s] = hits.X[h]; sat.Y[s] = hits.Y[h]; sat.Z[s] = hits.Z[h];
+          sat.ErrValid[s] = hits.ErrValid[h];
+          sat.Cxx[s] = hits.Cxx[h]; sat.Cyx[s] = hits.Cyx[h]; sat.Cyy[s] = hits.Cyy[h]; sat.Czz[s] = hits.Czz[h];
+          sat.Strips[s] = sat.SatStrips[s] = hits.Strips[h];
+          sat.NormCharge[s] = sat.Charge[s] = uniform(10.,30.);
+          sat.Norm[s] = sat.Cosine[s] = 1;
+        }
+      }
+    }
+    hits.TrackBegin.push_back(hits.NHits());
+  }
+
+  // saturated hits for the Hough finder: noise, the monopole hits are added above
+  MplHitCache &sat = ev.SatHits;
+  for ( unsigned i=0; i != nTracks/4; i++ ) {
+    const unsigned s = sat.Add();
+    const double r = uniform(20.,110.), phi = uniform(-M_PI,M_PI);
+    sat.X[s] = r*cos(phi); sat.Y[s] = r*sin(phi); sat.Z[s] = uniform(-200.,200.);
+    sat.ErrValid[s] = 1;
+    sat.Cxx[s] = sat.Cyy[s] = 0.02*0.02; sat.Cyx[s] = 0; sat.Czz[s] = 0.05*0.05;
+    sat.Strips[s] = sat.SatStrips[s] = 2;
+    sat.NormCharge[s] = sat.Charge[s] = uniform(5.,30.);
+    sat.Norm[s] = sat.Cosine[s] = 1;
+  }
+}
+
+bool sameHits(const MplHitCache &ha, const MplHitCache &hb)
+{
+  return ha.X == hb.X && ha.Y == hb.Y && ha.Z == hb.Z
+    && ha.Cxx == hb.Cxx && ha.Cyx == hb.Cyx && ha.Cyy == hb.Cyy && ha.Czz == hb.Czz
+    && ha.ErrValid == hb.ErrValid && ha.Strips == hb.Strips && ha.SatStrips == hb.SatStrips
+    && ha.NormCharge == hb.NormCharge;
+}
+
+bool sameEvent(const MplTrackEvent &a, const MplTrackEvent &b)
+{
+  return a.Run == b.Run && a.Event == b.Event
+    && a.Pt == b.Pt && a.Eta == b.Eta && a.Phi == b.Phi && a.Charge == b.Charge
+    && a.Hits.TrackBegin == b.Hits.TrackBegin && sameHits(a.Hits, b.Hits)
+    && sameHits(a.SatHits, b.SatHits);
+}
+
+// groups with too few hits have NaN parameters
+bool same(float a, float b) { return a == b || (a != a && b != b); }
+
+bool sameSet(const MplTrackSet &a, const MplTrackSet &b)
+{
+  for ( unsigned i=0; i != 3; i++ ) {
+    if ( !same(a.XYPar[i],b.XYPar[i]) || !same(a.XYErr[i],b.XYErr[i]) ) return false;
+    if ( !same(a.RZPar[i],b.RZPar[i]) || !same(a.RZErr[i],b.RZErr[i]) ) return false;
+  }
+  for ( unsigned i=0; i != MplDeDxEstimator::kNEstimators; i++ )
+    if ( a.DeDx[i] != b.DeDx[i] ) return false;
+  return a.Finder == b.Finder && a.Group == b.Group && same(a.Chi2XY,b.Chi2XY) && same(a.Chi2RZ,b.Chi2RZ) && a.Ndof == b.Ndof
+    && a.Iso == b.Iso && a.Hits == b.Hits && a.SatHits == b.SatHits
+    && a.SubHits == b.SubHits && a.SatSubHits == b.SatSubHits;
+}
+
+
+int main(int argc, char **argv) {
+
+  const unsigned nEvents = argc > 1 ? atoi(argv[1]) : 100;
+  const unsigned nTracks = argc > 2 ? atoi(argv[2]) : 200;
+  const std::string fileName = argc > 3 ? argv[3] : "mplReplayTest.bin";
+
+  MplTrackerConfig config;
+  config.DeDxMask = (1 << MplDeDxEstimator::kNEstimators) - 1;
+  config.Hough.Enable = true;
+  MplTrackEngine engine(config);
+
+  srand(4357);
+
+  std::vector<MplTrackEvent> events(nEvents);
+  {
+    MplReplayWriter writer(fileName);
+    assert( writer.Good() );
+    for ( unsigned e=0; e != nEvents; e++ ) {
+      makeEvent(1, e, nTracks, config.PtCut, events[e]);
+      writer.Write(events[e]);
+    }
+    assert( writer.Good() && writer.NEvents() == nEvents );
+  }
+
+  MplTrackerWorkspace direct(config), replayed(config);
+  MplTrackerResult directResult, replayResult;
+  MplTrackEvent ev;
+  unsigned nRead = 0, nSets = 0, nHough = 0;
+
+  MplReplayReader reader(fileName);
+  assert( reader.Good() );
+  while ( reader.Read(ev) ) {
+    assert( nRead < nEvents );
+    assert( sameEvent(ev, events[nRead]) );
+
+    engine.PrepareHits(events[nRead].Hits);
+    engine.PrepareHits(events[nRead].SatHits);
+    engine.PrepareHits(ev.Hits);
+    engine.PrepareHits(ev.SatHits);
+    engine.Process(events[nRead], direct, directResult);
+    engine.Process(ev, replayed, replayResult);
+
+    assert( directResult.Sets.size() == replayResult.Sets.size() );
+    for ( unsigned s=0; s != directResult.Sets.size(); s++ )
+      assert( sameSet(directResult.Sets[s], replayResult.Sets[s]) );
+
+    nSets += replayResult.Sets.size();
+    for ( unsigned s=0; s != replayResult.Sets.size(); s++ )
+      if ( replayResult.Sets[s].Finder == MplTrackSet::kHoughFinder ) nHough++;
+    nRead++;
+  }
+  assert( reader.Good() && nRead == nEvents );
+
+  // cut the last event short: the reader has to notice
+  FILE *file = fopen(fileName.c_str(), "rb");
+  fseek(file, 0, SEEK_END);
+  const long size = ftell(file);
+  std::vector<char> bytes(size);
+  fseek(file, 0, SEEK_SET);
+  const size_t nBytes = fread(&bytes[0], 1, size, file);
+  fclose(file);
+  assert( nBytes == (size_t)size );
+  file = fopen(fileName.c_str(), "wb");
+  fwrite(&bytes[0], 1, size-7, file);
+  fclose(file);
+
+  MplReplayReader truncated(fileName);
+  unsigned nTruncated = 0;
+  while ( truncated.Read(ev) ) nTruncated++;
+  assert( !truncated.Good() && nTruncated == nEvents-1 );
+
+  remove(fileName.c_str());
+
+  std::cout << nRead << " events, " << size << " bytes, " << nSets << " track sets, " << nHough << " from the Hough finder" << std::endl;
+  std::cout << "replayed events and results identical" << std::endl;
+
+  return 0;
+}
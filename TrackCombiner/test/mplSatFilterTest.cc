@@ -0,0 +1,150 @@
+///////////////////////////////////////////////
+// Run MplTrackEngine with and without the
+// saturation pre-filter on toy events: a filter
+// that passes everything gives the unfiltered
+// results, the default one only combines tracks
+// with saturated strips, all of the monopole
+// tracks among them.
+//   mplSatFilterTest [nEvents] [nTracks]
+///////////////////////////////////////////////
+
+#include <vector>
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <cmath>
+
+#include "Monopoles/TrackCombiner/interface/MplTrackEngine.h"
+
+
+double uniform(double lo, double hi) { return lo + (hi-lo)*(rand()+0.5)/(RAND_MAX+1.); }
+
+double gaus(double sigma) { return sigma*sqrt(-2*log(uniform(0.,1.)))*cos(2*M_PI*uniform(0.,1.)); }
+
+
+// toy event: two monopoles split into several tracks, ordinary tracks with
+// a saturated strip now and then
+void makeEvent(unsigned event, unsigned nTracks, std::vector<int> &mono, MplTrackEvent &ev)
+{
+  ev.Clear();
+  ev.Run = 1;
+  ev.Event = event;
+  mono.clear();
+
+  MplHitCache &hits = ev.Hits;
+  hits.TrackBegin.push_back(0);
+
+  for ( unsigned t=0; t != nTracks; t++ ) {
+    const unsigned m = rand()%10;
+    mono.push_back(m < 2 ? m : -1);
+    const double phi = m < 2 ? m*M_PI/2 + gaus(0.01) : uniform(-M_PI,M_PI);
+    const double slope = m < 2 ? 0.3 : uniform(-2.,2.);
+    const double curv = m < 2 ? 1e-3 : 0.;
+
+    ev.Pt.push_back(m < 2 ? uniform(20.,200.) : uniform(3.,20.));
+    ev.Eta.push_back(asinh(slope));
+    ev.Phi.push_back(phi);
+    ev.Charge.push_back(rand()%2 ? 1 : -1);
+
+    const unsigned nHits = 8 + rand()%12;
+    for ( unsigned i=0; i != nHits; i++ ) {
+      const double r = 4. + 105.*i/(nHits-1);
+      const unsigned h = hits.Add();
+
+      hits.X[h] = r*cos(phi) + gaus(0.02);
+      hits.Y[h] = r*sin(phi) + gaus(0.02);
+      hits.Z[h] = slope*r + curv*r*r + gaus(0.05);
+      hits.ErrValid[h] = 1;
+      hits.Cxx[h] = hits.Cyy[h] = 0.02*0.02;
+      hits.Cyx[h] = 0;
+      hits.Czz[h] = 0.05*0.05;
+
+      hits.Strips[h] = m < 2 ? 10 + rand()%20 : 1 + rand()%5;
+      hits.SatStrips[h] = m < 2 ? hits.Strips[h]/2 + rand()%(hits.Strips[h]/2) : rand()%50 == 0;
+      hits.NormCharge[h] = hits.Charge[h] = m < 2 ? uniform(10.,30.) : uniform(1.,6.);
+      hits.Norm[h] = hits.Cosine[h] = 1;
+    }
+    hits.TrackBegin.push_back(hits.NHits());
+  }
+}
+
+// groups with too few hits have NaN parameters
+bool same(float a, float b) { return a == b || (a != a && b != b); }
+
+bool sameSet(const MplTrackSet &a, const MplTrackSet &b)
+{
+  for ( unsigned i=0; i != 3; i++ )
+    if ( !same(a.XYPar[i],b.XYPar[i]) || !same(a.RZPar[i],b.RZPar[i]) ) return false;
+  return a.Group == b.Group && same(a.Chi2XY,b.Chi2XY) && same(a.Chi2RZ,b.Chi2RZ)
+    && a.Iso == b.Iso && a.Hits == b.Hits && a.SatSubHits == b.SatSubHits;
+}
+
+bool passes(const MplTrackerConfig &config, const MplHitCache &hits, unsigned track)
+{
+  int strips = 0, satStrips = 0;
+  for ( unsigned h=hits.Begin(track); h != hits.End(track); h++ ) {
+    strips += hits.Strips[h];
+    satStrips += hits.SatStrips[h];
+  }
+  return config.SatSelect(strips, satStrips);
+}
+
+
+int main(int argc, char **argv) {
+
+  const unsigned nEvents = argc > 1 ? atoi(argv[1]) : 100;
+  const unsigned nTracks = argc > 2 ? atoi(argv[2]) : 200;
+
+  MplTrackerConfig config;
+  MplTrackEngine unfiltered(config);
+
+  config.SatFilter = true;
+  MplTrackEngine filtered(config);
+
+  config.SatFilterFraction = 0;
+  config.SatFilterMinStrips = 0;
+  MplTrackEngine open(config);
+
+  MplTrackerWorkspace unfilteredWork(unfiltered.Config()), filteredWork(filtered.Config()), openWork(open.Config());
+  MplTrackerResult unfilteredResult, filteredResult, openResult;
+
+  srand(4357);
+
+  MplTrackEvent ev;
+  std::vector<int> mono;
+  unsigned nSets = 0, nFiltered = 0;
+
+  for ( unsigned e=0; e != nEvents; e++ ) {
+    makeEvent(e, nTracks, mono, ev);
+    unfiltered.PrepareHits(ev.Hits);
+
+    unfiltered.Process(ev, unfilteredWork, unfilteredResult);
+    filtered.Process(ev, filteredWork, filteredResult);
+    open.Process(ev, openWork, openResult);
+
+    assert( openResult.Sets.size() == unfilteredResult.Sets.size() );
+    for ( unsigned s=0; s != openResult.Sets.size(); s++ )
+      assert( sameSet(openResult.Sets[s], unfilteredResult.Sets[s]) );
+
+    // only passing tracks are combined, every monopole track among them
+    std::vector<bool> combined(nTracks, false);
+    for ( unsigned s=0; s != filteredResult.Sets.size(); s++ ) {
+      const MplTrackSet &set = filteredResult.Sets[s];
+      for ( unsigned i=0; i != set.Group.size(); i++ ) {
+        assert( passes(filtered.Config(), ev.Hits, set.Group[i]) );
+        combined[set.Group[i]] = true;
+      }
+    }
+    for ( unsigned t=0; t != nTracks; t++ )
+      if ( mono[t] >= 0 ) assert( combined[t] );
+
+    nSets += unfilteredResult.Sets.size();
+    nFiltered += filteredResult.Sets.size();
+  }
+
+  std::cout << nEvents << " events of " << nTracks << " tracks: " << nSets << " sets unfiltered, "
+            << nFiltered << " with the saturation filter" << std::endl;
+  std::cout << filtered.Summary(filteredWork) << std::endl;
+
+  return 0;
+}